@@ -1,43 +1,250 @@
 #ifndef AIPLAYER_HPP
 #define AIPLAYER_HPP
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iosfwd>
+#include <memory>
+#include <stop_token>
 #include <string>
+#include <thread>
 #include <vector>
-#include <unordered_map>
+#include "Board.hpp"
+#include "EvalCache.hpp"
+#include "MovePicker.hpp"
+#include "TranspositionTable.hpp"
 
-class Board; // forward
+class Tablebase;
+class MateSolver;
+class PawnHash;
+
+// One root move with its score and principal variation (MultiPV)
+struct PVLine {
+    std::string move;
+    double score = 0.0;      // from the AI's point of view
+    std::vector<std::string> pv;
+};
+
+// Progress report after each completed iterative-deepening depth
+struct SearchInfo {
+    int depth = 0;
+    std::string bestMove;
+    double score = 0.0;      // from the AI's point of view
+    std::vector<std::string> pv; // principal variation, bestMove first
+    uint64_t nodes = 0;      // nodes searched so far in this search
+    double elapsedMs = 0.0;  // since the search started
+    std::vector<PVLine> lines; // the best SearchLimits::multiPV root moves, best first
+};
+
+// Counters for one findBestMove call. Plain increments on a member, so they
+// cost nothing measurable next to a node; formatting only happens when a
+// stats sink is set.
+struct SearchStats {
+    struct Depth {
+        int depth = 0;
+        uint64_t nodes = 0;       // nodes in this iteration alone
+        double elapsedMs = 0.0;   // time for this iteration alone
+        std::string bestMove;
+        double score = 0.0;
+    };
+
+    char color = 'W';
+    std::string bestMove;
+    std::vector<std::string> pv;  // principal variation read back from the TT
+    double score = 0.0;
+    double baseScore = 0.0;       // static eval of the root
+    uint64_t nodes = 0;           // alphaBeta calls, root included
+    uint64_t qnodes = 0;          // horizon (depth 0) evaluations
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t ttCutoffs = 0;       // hits deep enough to return straight away
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;// cutoffs produced by the first move tried
+    uint64_t tbHits = 0;
+    uint64_t evalProbes = 0;      // static evaluations asked for by the search
+    uint64_t evalHits = 0;        // answered by the eval cache
+    uint64_t pawnProbes = 0;      // pawn-structure lookups by evaluateBoard
+    uint64_t pawnHits = 0;
+    uint64_t mateNodes = 0;       // spent by the mate solver before the main search
+    bool stopped = false;         // ended by a stop request or a limit, not by depth
+    bool ponderHit = false;       // answered by the background (ponder) search
+    double elapsedMs = 0.0;       // search time; includes pondering on a ponder hit
+    std::vector<Depth> depths;
+    std::vector<PVLine> lines;    // top root lines of the last completed depth
+
+    double nps() const { return elapsedMs > 0 ? nodes * 1000.0 / elapsedMs : 0.0; }
+    // nodes(last depth) / nodes(previous depth)
+    double effectiveBranchingFactor() const;
+    double firstMoveCutoffRate() const { return betaCutoffs ? double(firstMoveCutoffs) / betaCutoffs : 0.0; }
+    double ttHitRate() const { return ttProbes ? double(ttHits) / ttProbes : 0.0; }
+    double evalHitRate() const { return evalProbes ? double(evalHits) / evalProbes : 0.0; }
+    double pawnHitRate() const { return pawnProbes ? double(pawnHits) / pawnProbes : 0.0; }
+
+    // One JSON object on one line (JSON-lines)
+    void writeJson(std::ostream &out) const;
+};
+
+// Limits for one search; zero means "not limited by this"
+struct SearchLimits {
+    int depth = 0;            // 0 = the player's maxDepth (or unbounded if time/nodes are set)
+    double movetimeMs = 0.0;
+    uint64_t nodes = 0;
+    // Root lines to report. Above 1 the search is treated as analysis: the
+    // random root bias is left out so the lines are ranked on score alone.
+    int multiPV = 1;
+};
+
+struct SearchResult {
+    std::string bestMove;
+    double score = 0.0;
+    std::vector<std::string> pv;
+    std::vector<PVLine> lines;
+    bool stopped = false;
+    SearchStats stats;
+};
 
 class AIPlayer {
+  friend class MicroBench; // bench_micro times the private primitives
 public:
     AIPlayer(char color, int maxDepth = 2);  // color = 'W' or 'B'
+    ~AIPlayer();
+    AIPlayer(const AIPlayer &) = delete;
+    AIPlayer &operator=(const AIPlayer &) = delete;
 
     // Public API
     std::string findBestMove(Board& board);
+
+    // Search on a background thread. Completed depths are reported through
+    // onInfo (falls back to the info callback); requesting stop on the token
+    // ends the search early with the best move of the last completed depth.
+    // The AIPlayer must outlive the future and not be used until it is ready.
+    std::future<SearchResult> startSearch(const Board &board, SearchLimits limits = SearchLimits(),
+                                          std::stop_token stop = std::stop_token(),
+                                          std::function<void(const SearchInfo &)> onInfo = {});
+
+    // Synchronous form of startSearch, for callers that already run on a worker thread
+    SearchResult runSearch(const Board &board, const SearchLimits &limits = SearchLimits(),
+                           std::stop_token stop = std::stop_token(),
+                           const std::function<void(const SearchInfo &)> &onInfo = {});
+
+    // Score a single root move to the given depth (the move counts as one ply),
+    // from the side to move's view; the player's colour must be the side to
+    // move. Returns false if stopped. Nodes are in lastSearchStats().
+    bool searchRootMove(const Board &board, const std::string &move, int depth, double &score,
+                        std::stop_token stop = std::stop_token());
+
+    // Share a transposition table with other players/searches (thread-safe)
+    void setTranspositionTable(std::shared_ptr<TranspositionTable> table) { tt = std::move(table); }
+    TranspositionTable &transpositionTable() { return *tt; }
+
+    // Optional: share one eval cache between players (it is lock-free)
+    void setEvalCache(std::shared_ptr<EvalCache> cache) { evalCache = std::move(cache); }
+
     double evaluateBoard(const Board& board) const;
 
     // Optional: adjust search depth
     void setMaxDepth(int d) { maxDepth = d; }
 
+    // Optional: turn off the root-move bias (the random bonuses and the
+    // king-move penalty), making searches reproducible (same position and
+    // limits -> same nodes and move) and root scores plain search scores
+    void setRandomBias(bool on) { randomBias = on; }
+
+    // Optional: endgame tablebases probed at the root and inside the search
+    void setTablebase(const Tablebase *tb) { tablebase = tb; }
+
+    // Optional: when a root move gives check, first try to prove a mate in
+    // at most maxMoves with the df-pn solver, within nodes nodes (0 disables)
+    void setMateSearch(uint64_t nodes, int maxMoves = 3);
+
+    // Optional: called after every completed depth of findBestMove
+    void setInfoCallback(std::function<void(const SearchInfo &)> cb) { infoCallback = std::move(cb); }
+
+    // Counters of the last findBestMove call
+    const SearchStats &lastSearchStats() const { return stats; }
+    double averageThinkingMs() const { return movesCount ? totalThinkingTime / movesCount * 1000.0 : 0.0; }
+
+    // Optional: append one JSON line per search to out (nullptr disables)
+    void setStatsSink(std::ostream *out) { statsSink = out; }
+
+    // Pondering: call with the position after our move, while the opponent
+    // thinks. The expected reply (second PV move) is searched on a background
+    // thread. The next findBestMove either picks that search up (ponder hit)
+    // or stops and discards it.
+    void startPondering(const Board &board);
+    void stopPondering();
+    bool isPondering() const { return ponderThread.joinable(); }
+
 private:
     char playerColor;
     std::string lastMoveFrom;
 
     // Search params / stats
     int maxDepth;
+    bool randomBias = true;
     double totalThinkingTime = 0.0;
     int movesCount = 0;
+    SearchStats stats;
+    std::ostream *statsSink = nullptr;
+    std::function<void(const SearchInfo &)> infoCallback;
 
-    // Transposition table entry
-    struct TTEntry {
-        double value;
-        int depth; // depth at which value was computed
-    };
-    std::unordered_map<std::string, TTEntry> tt;
+    // Transposition table; private to this player unless one is shared in
+    std::shared_ptr<TranspositionTable> tt;
+
+    // Set to abandon the running search (stop token or limit reached);
+    // aborted results never reach the TT
+    std::atomic<bool> stopRequested{ false };
+    SearchLimits activeLimits;
+    std::chrono::high_resolution_clock::time_point searchStart;
+    static constexpr int MAX_SEARCH_DEPTH = 64;
+
+    // Move ordering memory for the MovePicker, cleared at every search:
+    // two quiet cutoff moves per remaining depth, and cutoff counts by from/to
+    std::array<MovePicker::Killers, MAX_SEARCH_DEPTH + 1> killers;
+    MovePicker::History history{};
+    void resetMoveOrdering();
+
+    // Background search on the opponent's time
+    std::jthread ponderThread;
+    Board ponderBoard;        // position after the expected reply
+    std::string ponderResult;
+
+    // Endgame tablebases (not owned); tablebase wins score just below this
+    const Tablebase *tablebase = nullptr;
+    static constexpr double TB_WIN_SCORE = 500.0;
+
+    // Static scores by position key, checked before evaluateBoard in the search
+    std::shared_ptr<EvalCache> evalCache;
+
+    // Pawn-structure scores by pawn key; evaluateBoard is const but fills it
+    std::unique_ptr<PawnHash> pawnHash;
+
+    // Mate solver for forcing roots, created on first use
+    std::unique_ptr<MateSolver> mateSolver;
+    uint64_t mateNodes = 0;
+    int mateMoves = 3;
+    static constexpr double MATE_SCORE = 1000.0; // minus the moves to mate
+    bool mateRootMove(const Board &board, const std::vector<std::string> &legalMoves, std::stop_token stop);
 
     // Helpers
     double pieceValue(char piece) const;
     std::vector<std::string> generateAllLegalMoves(Board &board, char color) const;
+    double staticEval(const Board &board);
     double alphaBeta(Board &board, int depth, double alpha, double beta, bool maximizing);
+    std::string search(Board &board, const SearchLimits &limits, std::stop_token stop,
+                       const std::function<void(const SearchInfo &)> &onInfo);
+    std::string think(Board &board, const SearchLimits &limits, std::stop_token stop,
+                      const std::function<void(const SearchInfo &)> &onInfo);
+    bool limitReached();
+    double rootMoveValue(const Board &board, const std::string &mv, int depth);
+    void finishMove(const std::string &move, std::chrono::high_resolution_clock::time_point t0);
+    std::vector<std::string> principalVariation(const Board &board, std::string first, int maxLength) const;
+    bool tablebaseRootMove(Board &board, const std::vector<std::string> &moves,
+                           std::string &best, int &wdl) const;
 
     // string key builder for TT
     std::string boardKey(const Board &board) const;
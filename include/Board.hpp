@@ -2,20 +2,34 @@
 #define BOARD_HPP
 
 #include <array>
+#include <cstdint>
 #include <string>
-#include <iostream>
+#include <vector>
 
 class Board {
   friend class AIPlayer; // AIPlayer can now access private members
+  friend class Tablebase; // probing needs castling / en-passant state
+  friend class MicroBench; // bench_micro times the private primitives
+  friend class MovePicker; // tells good captures from losing ones
 public:
     Board();                                // Constructor: sets up initial board, player, and last move
     void display() const;                   // Print board in terminal with current player and last move
 
+    // FEN I/O. loadFEN returns false (leaving the board untouched) if the string is malformed;
+    // the move counters may be omitted, as in EPD records.
+    bool loadFEN(const std::string &fen);
+    std::string toFEN() const;
+
+    // Convert a SAN move ("Nf3", "exd5", "O-O", "e8=Q+") to "e2e4" format; "" if not legal here
+    std::string moveFromSAN(const std::string &san) const;
+
     // Apply a move in format "e2e4". Returns true if move was legal and applied.
     bool makeMove(const std::string &move);
 
     // Accessor for current player (useful for main / checking game state)
     char getCurrentPlayer() const { return currentPlayer; }
+    // Plies since the last capture or pawn move (fifty-move rule)
+    int getHalfmoveClock() const { return halfmoveClock; }
 
     // Check utilities
     bool isInCheck(char color) const;       // true if 'W' or 'B' king is under attack
@@ -27,6 +41,25 @@ public:
     // Check if a move is valid
     bool isMoveValid(const std::string &move) const { return validateMove(move).empty(); }
 
+    // Move validation with detailed error messages ("" if the move is legal)
+    std::string validateMove(const std::string &move) const;
+
+    // All legal moves for the side to move, in from-square then to-square order.
+    // Only squares the piece could reach are validated, not all 64.
+    std::vector<std::string> legalMoves() const;
+    // The same split in two: captures (en passant included) and promotions,
+    // then everything else; each keeps legalMoves' order
+    std::vector<std::string> legalCaptures() const;
+    std::vector<std::string> legalQuiets() const;
+
+    // Zobrist key of the whole position: pieces, side to move, castling
+    // flags and en-passant file. Recomputed from the squares on each call.
+    uint64_t zobristKey() const;
+
+    // Zobrist key of the pawns alone (0 when there are none); equal pawn
+    // structures share a key whatever the other pieces do
+    uint64_t pawnKey() const;
+
 private:
     std::array<std::array<char, 8>, 8> squares; // 8x8 board; '.' is empty
     char currentPlayer;                     // 'W' for White (uppercase pieces), 'B' for Black (lowercase)
@@ -45,8 +78,9 @@ private:
     int enPassantX = -1;
     int enPassantY = -1;
 
-    // Move validation with detailed error messages
-    std::string validateMove(const std::string &move) const;
+    // FEN move counters: plies since the last capture or pawn move, and the full move number
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
 
     // A lower-level checker that verifies piece movement & capture rules but ignores player-turn,
     // used to enumerate pseudo-legal moves when testing for checkmate/stalemate.
@@ -74,6 +108,10 @@ private:
 
     // When searching for legal moves we need to test moves by applying them and undoing them.
     bool hasAnyLegalMove(char color) const;
+
+    // legalMoves, restricted to tactical moves, quiet moves or both
+    std::vector<std::string> generateMoves(bool tactical, bool quiet) const;
+    bool isTactical(int fromX, int fromY, int toX, int toY) const;
 };
 
 #endif
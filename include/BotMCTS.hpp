@@ -0,0 +1,75 @@
+#ifndef BOTMCTS_HPP
+#define BOTMCTS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "Bot.hpp"
+#include "Board.hpp"
+
+// Monte Carlo tree search bot. Several threads grow one shared tree with UCT
+// selection; a virtual loss on the path being explored steers the other
+// threads elsewhere until its playout is backed up. Playouts are short random
+// games (optionally capture-greedy) scored by material, so the engine scales
+// with cores rather than with evaluation depth. The tree below the move that
+// was actually played is kept for the next move.
+class BotMCTS : public Bot {
+public:
+    enum class Playout { Random, Guided };
+
+    struct Stats {
+        uint64_t iterations = 0;   // playouts in the last getMove
+        uint64_t rootVisits = 0;   // including those reused from the previous move
+        uint64_t reusedVisits = 0; // visits inherited from the previous tree
+        double winRate = 0.0;      // of the chosen move, for the bot
+        double elapsedMs = 0.0;
+    };
+
+    explicit BotMCTS(int threads = 0, double moveTimeMs = 1000.0, Playout playout = Playout::Guided);
+    ~BotMCTS() override;
+
+    std::string getMove(Board &board, char botColor) override;
+
+    void setMoveTime(double ms) { moveTimeMs = ms; }
+    void setIterations(uint64_t n) { maxIterations = n; } // 0 = time only
+    const Stats &lastStats() const { return stats; }
+
+private:
+    struct Node {
+        std::string move;                  // move that led here ("" at the root)
+        Node *parent = nullptr;
+        std::vector<std::unique_ptr<Node>> children;
+        std::atomic<bool> expanded{ false };
+        std::mutex expandMutex;
+        std::atomic<int> visits{ 0 };      // includes virtual losses in flight
+        std::atomic<double> wins{ 0.0 };   // for the side that played move
+        bool terminal = false;
+        double terminalValue = 0.0;        // for the side that played move
+    };
+
+    int threads;
+    double moveTimeMs;
+    uint64_t maxIterations = 0;
+    Playout playout;
+    Stats stats;
+
+    std::unique_ptr<Node> root;
+    std::string rootFen;                   // position at the root, without move counters
+
+    static constexpr double EXPLORATION = 1.4;
+    static constexpr int PLAYOUT_PLIES = 24;
+
+    void iterate(const Board &rootBoard, std::mt19937 &rng);
+    Node *select(Node *node, Board &board);
+    void expand(Node *node, const Board &board);
+    double simulate(Board board, std::mt19937 &rng) const;
+    void reuseTree(const Board &board);
+    static std::string positionKey(const Board &board);
+    static double materialBalance(const Board &board); // White's view, in pawns
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef EVALCACHE_HPP
+#define EVALCACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-size cache of static evaluations, keyed by Board::zobristKey.
+// Direct-mapped and always-replace; written without locks in the same way
+// as SharedTranspositionTable (key stored XORed with the score bits, so a
+// torn write reads as a miss), which lets searchers on several threads
+// share one cache. Scores are kept from White's point of view.
+class EvalCache {
+public:
+    // entries is rounded down to a power of two (16 bytes each)
+    explicit EvalCache(std::size_t entries = 1u << 16);
+
+    bool probe(uint64_t key, double &whiteScore) const;
+    void store(uint64_t key, double whiteScore);
+    void clear();
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    // An empty slot only matches key 0
+    struct Slot {
+        std::atomic<uint64_t> keyXorData{ 0 };
+        std::atomic<uint64_t> data{ 0 };
+    };
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+};
+
+#endif
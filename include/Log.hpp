@@ -0,0 +1,66 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <functional>
+#include <sstream>
+#include <string>
+
+// Level-gated logging for the engine core. Statements above CHESSAI_LOG_LEVEL
+// are removed by the preprocessor, so release builds (NDEBUG, level 0 by
+// default) contain no logging code and no console I/O at all.
+//
+//   LOG_DEBUG("depth " << d << " best " << move);
+
+#define CHESSAI_LOG_LEVEL_NONE  0
+#define CHESSAI_LOG_LEVEL_ERROR 1
+#define CHESSAI_LOG_LEVEL_WARN  2
+#define CHESSAI_LOG_LEVEL_INFO  3
+#define CHESSAI_LOG_LEVEL_DEBUG 4
+
+#ifndef CHESSAI_LOG_LEVEL
+#  ifdef NDEBUG
+#    define CHESSAI_LOG_LEVEL CHESSAI_LOG_LEVEL_NONE
+#  else
+#    define CHESSAI_LOG_LEVEL CHESSAI_LOG_LEVEL_DEBUG
+#  endif
+#endif
+
+namespace chesslog {
+    // Deliver one formatted message; goes to std::cerr unless a sink is set
+    void write(int level, const std::string &message);
+    // Redirect log output (e.g. into a GUI or a file); an empty function restores std::cerr
+    void setSink(std::function<void(int level, const std::string &message)> sink);
+}
+
+#define CHESSAI_LOG(level, expr)                                   \
+    do {                                                           \
+        std::ostringstream chesslog_stream_;                       \
+        chesslog_stream_ << expr;                                  \
+        chesslog::write(level, chesslog_stream_.str());            \
+    } while (0)
+
+#if CHESSAI_LOG_LEVEL >= CHESSAI_LOG_LEVEL_ERROR
+#  define LOG_ERROR(expr) CHESSAI_LOG(CHESSAI_LOG_LEVEL_ERROR, expr)
+#else
+#  define LOG_ERROR(expr) do { } while (0)
+#endif
+
+#if CHESSAI_LOG_LEVEL >= CHESSAI_LOG_LEVEL_WARN
+#  define LOG_WARN(expr) CHESSAI_LOG(CHESSAI_LOG_LEVEL_WARN, expr)
+#else
+#  define LOG_WARN(expr) do { } while (0)
+#endif
+
+#if CHESSAI_LOG_LEVEL >= CHESSAI_LOG_LEVEL_INFO
+#  define LOG_INFO(expr) CHESSAI_LOG(CHESSAI_LOG_LEVEL_INFO, expr)
+#else
+#  define LOG_INFO(expr) do { } while (0)
+#endif
+
+#if CHESSAI_LOG_LEVEL >= CHESSAI_LOG_LEVEL_DEBUG
+#  define LOG_DEBUG(expr) CHESSAI_LOG(CHESSAI_LOG_LEVEL_DEBUG, expr)
+#else
+#  define LOG_DEBUG(expr) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef MATESOLVER_HPP
+#define MATESOLVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <string>
+#include <vector>
+#include "Board.hpp"
+
+// Depth-first proof-number (df-pn) search for forced mates by the side to
+// move. Unlike alpha-beta it only expands the most promising part of the
+// tree (fewest defender replies to refute), so narrow forcing lines are
+// proven long before a full-width search of the same depth completes.
+//
+// Proof and disproof numbers live in a fixed-size table of their own, so
+// memory is bounded whatever the node budget. Mates are searched for in
+// increasing length, which makes the reported mate the shortest one.
+class MateSolver {
+public:
+    struct Result {
+        bool mate = false;            // a forced mate was proven
+        int mateIn = 0;               // in moves of the side to move
+        std::string move;             // first move of the mate
+        std::vector<std::string> pv;  // attacker and defender moves to the mate
+        uint64_t nodes = 0;
+        double elapsedMs = 0.0;
+        bool exhausted = false;       // stopped by the node budget or the stop token
+    };
+
+    // ttEntries is rounded down to a power of two (24 bytes each)
+    explicit MateSolver(std::size_t ttEntries = 1u << 20);
+
+    // Look for a mate in at most maxMoves moves within maxNodes nodes
+    Result solve(const Board &board, int maxMoves, uint64_t maxNodes = 1000000,
+                 std::stop_token stop = std::stop_token());
+    void clear();
+
+private:
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t pn = 1, dn = 1;
+        uint32_t work = 0;            // nodes spent under this entry, for replacement
+    };
+    static constexpr uint32_t INF = 100000000;
+
+    std::vector<Entry> table;
+    uint64_t mask;
+
+    char attacker = 'W';
+    uint64_t nodes = 0, nodeLimit = 0;
+    std::stop_token stopToken;
+    bool aborted = false;
+
+    void mid(const Board &board, int pliesLeft, uint32_t thpn, uint32_t thdn, uint32_t &pn, uint32_t &dn);
+    bool lookup(uint64_t key, uint32_t &pn, uint32_t &dn) const;
+    void store(uint64_t key, uint32_t pn, uint32_t dn, uint32_t work);
+    uint64_t positionKey(const Board &board, int pliesLeft) const;
+    std::vector<std::string> provenLine(const Board &board, int pliesLeft) const;
+};
+
+#endif
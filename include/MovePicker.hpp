@@ -0,0 +1,51 @@
+#ifndef MOVEPICKER_HPP
+#define MOVEPICKER_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include "Board.hpp"
+
+// Hands out the legal moves of a position one at a time, best guesses first,
+// generating each group only when the previous ones are used up:
+//
+//   1. the transposition-table move (validated, not generated)
+//   2. good captures (and promotions), most valuable victim first
+//   3. the two killer moves of this depth (validated, must be quiet)
+//   4. the other quiet moves, by history score
+//   5. losing captures: a bigger piece takes a defended smaller one
+//
+// A node that cuts off on the hash move or a capture never generates its
+// quiet moves. No move at all from next() means no legal moves.
+class MovePicker {
+public:
+    using Killers = std::array<std::string, 2>;
+    using History = std::array<std::array<int, 64>, 64>; // [from][to], square = y*8+x
+
+    MovePicker(const Board &board, const std::string &ttMove, const Killers &killers, const History &history);
+
+    bool next(std::string &move);
+
+    // A quiet move that has no capture or promotion in this position
+    static bool isQuiet(const Board &board, const std::string &move);
+    static int square(char file, char rank) { return ('8' - rank) * 8 + (file - 'a'); }
+
+private:
+    enum class Stage { TtMove, GenCaptures, GoodCaptures, Killers, GenQuiets, Quiets, BadCaptures, Done };
+
+    const Board &board;
+    std::string ttMove;
+    const Killers &killers;
+    const History &history;
+    Stage stage = Stage::TtMove;
+
+    std::vector<std::string> moves;      // current batch, best first
+    std::vector<std::string> badCaptures;
+    std::size_t index = 0, killerIndex = 0;
+
+    bool alreadyTried(const std::string &move) const;
+    bool losingCapture(const std::string &move) const;
+    static int value(char piece);
+};
+
+#endif
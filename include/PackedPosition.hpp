@@ -0,0 +1,76 @@
+#ifndef PACKEDPOSITION_HPP
+#define PACKEDPOSITION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Board;
+
+// One training position in 32 bytes: the board, the search score and the
+// final game result.
+//
+//   occupancy : bit y*8+x set for every occupied square (y = 0 is rank 8)
+//   pieces    : one nibble per occupied square, in occupancy order,
+//               1..12 = "PNBRQKpnbrqk"
+//   flags     : bit 0 black to move, bits 1-4 castling rights KQkq
+//   epFile    : en-passant file 0-7, or 0xff
+//   score     : search score in centipawns, side to move's view
+//   result    : game result from White's view: 1 win, 0 draw, -1 loss
+//
+// Fields are written in host byte order, like the tablebase files.
+struct PackedPosition {
+    uint64_t occupancy = 0;
+    uint8_t pieces[16] = {};
+    uint8_t flags = 0;
+    uint8_t epFile = 0xff;
+    int16_t score = 0;
+    int8_t result = 0;
+    uint8_t halfmoveClock = 0;
+    uint16_t fullmoveNumber = 1;
+
+    static PackedPosition pack(const Board &board, double score, int result);
+    std::string toFEN() const;
+};
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+// Packed positions are written in blocks of up to BLOCK_POSITIONS. Each block
+// is "CAIPOS01", uint32 position count, uint32 payload size, then the
+// payload. Consecutive records are usually consecutive plies of one game, so
+// the payload stores each record's difference from the next ply predicted
+// from the one before (board as one nibble per square), laid out field by
+// field across the block and run-length coded. Self-play data comes to
+// about 6.5 bytes per position, against about 60 for a FEN line.
+class PackedWriter {
+public:
+    static constexpr std::size_t BLOCK_POSITIONS = 4096;
+
+    bool open(const std::string &path);
+    void write(const PackedPosition &pos);
+    bool close();                      // flushes the last block
+    ~PackedWriter() { close(); }
+
+    uint64_t positions() const { return written; }
+    uint64_t bytes() const { return bytesOut; }
+
+private:
+    std::ofstream out;
+    std::vector<PackedPosition> block;
+    uint64_t written = 0, bytesOut = 0;
+
+    void flush();
+};
+
+class PackedReader {
+public:
+    bool open(const std::string &path);
+    // Next block of positions; false at the end of the file or on a bad block
+    bool readBlock(std::vector<PackedPosition> &positions);
+
+private:
+    std::ifstream in;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef PAWNSTRUCTURE_HPP
+#define PAWNSTRUCTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Board.hpp"
+
+// Doubled, isolated, backward and passed pawns, from White's point of view,
+// in pawns. Depends on the pawns alone, so it can be cached by Board::pawnKey.
+double pawnStructureScore(const Board &board);
+
+// Small direct-mapped cache of pawnStructureScore. Pawn structures change
+// far more slowly than positions, so nearly every leaf is a hit. Not
+// thread-safe: one per searcher.
+class PawnHash {
+public:
+    // entries is rounded down to a power of two (16 bytes each)
+    explicit PawnHash(std::size_t entries = 1u << 14);
+
+    double probe(const Board &board);
+    void clear();
+
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    void resetCounters() { probes = hits = 0; }
+
+private:
+    // Key 0 is the pawnless position, which scores 0, so an empty slot
+    // never answers wrongly
+    struct Entry {
+        uint64_t key = 0;
+        double score = 0.0;
+    };
+    std::vector<Entry> table;
+    uint64_t mask;
+};
+
+#endif
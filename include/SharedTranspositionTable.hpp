@@ -0,0 +1,64 @@
+#ifndef SHAREDTRANSPOSITIONTABLE_HPP
+#define SHAREDTRANSPOSITIONTABLE_HPP
+
+#include "TranspositionTable.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fixed-size transposition table in POSIX shared memory, so several ChessAI
+// processes on one machine can search into the same table.
+//
+// Entries are 16 bytes, two per bucket (depth-preferred + always-replace), and
+// are written without locks: the key is stored XORed with the data word, so a
+// torn write from a concurrent store fails the key check and reads as a miss.
+// Keys are 64-bit hashes of AIPlayer::boardKey; values are kept as float and
+// moves as from/to square indexes.
+//
+// The segment lives until it is removed (SharedTranspositionTable::remove or
+// rm /dev/shm/<name>); processes attaching to an existing one use its size.
+class SharedTranspositionTable : public TranspositionTable {
+public:
+    SharedTranspositionTable() = default;
+    ~SharedTranspositionTable() override;
+
+    // Create or attach to the segment "/name" of about sizeMb megabytes.
+    // hugePages asks the kernel to back it with transparent huge pages
+    // (needs /sys/kernel/mm/transparent_hugepage/shmem_enabled = advise).
+    bool attach(const std::string &name, std::size_t sizeMb, bool hugePages = false);
+    bool attached() const { return buckets != nullptr; }
+    std::size_t bucketCount() const { return bucketMask + 1; }
+
+    bool probe(const std::string &key, Entry &out) const override;
+    void store(const std::string &key, const Entry &entry) override;
+    void clear() override;
+    std::size_t size() const override; // estimated from a sample of buckets
+
+    static bool remove(const std::string &name);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+    struct Bucket {
+        Slot slots[2]; // [0] depth-preferred, [1] always-replace
+    };
+    struct Header {
+        std::atomic<uint64_t> magic;
+        uint64_t bucketCount;
+    };
+    static constexpr uint64_t MAGIC = 0x43484553534d5454ULL; // "CHESSMTT"
+
+    void *mapping = nullptr;
+    std::size_t mappingBytes = 0;
+    Bucket *buckets = nullptr;
+    uint64_t bucketMask = 0;
+
+    static uint64_t hashKey(const std::string &key);
+    static uint64_t pack(const Entry &entry);
+    static void unpack(uint64_t data, Entry &out);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef TABLEBASE_HPP
+#define TABLEBASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+class Board;
+
+// Endgame tablebases for every 3- and 4-man material combination.
+//
+// Tables are built by retrograde analysis (Tablebase::generate) and stored as
+// two files per material signature, e.g. "KRvK.wdl" and "KRvK.dtz":
+//   .wdl : win/draw/loss for the side to move, 2 bits per position
+//   .dtz : plies to the next zeroing move (capture or pawn move), 1 byte
+// The files are memory-mapped on load, so probing costs a page lookup.
+//
+// The tables follow the engine's own rules: promotions are always to a queen,
+// and positions with castling rights or an en-passant square are not probed.
+// The 50-move rule is ignored.
+class Tablebase {
+public:
+    enum Result { TB_LOSS = -1, TB_DRAW = 0, TB_WIN = 1 };
+
+    Tablebase() = default;
+    ~Tablebase();
+    Tablebase(const Tablebase &) = delete;
+    Tablebase &operator=(const Tablebase &) = delete;
+
+    // Map every table found in dir. Returns the number of tables loaded.
+    int load(const std::string &dir);
+    int tableCount() const { return static_cast<int>(tables.size()); }
+    int maxPieces() const { return maxLoadedPieces; }
+
+    // Probe from the side to move's point of view. Return false if the
+    // position is not covered (too many pieces, missing table, castling/ep).
+    // dtz is the number of plies to the next zeroing move (0 for draws/mates).
+    bool probeWDL(const Board &board, int &wdl) const;
+    bool probe(const Board &board, int &wdl, int &dtz) const;
+
+    // Build all tables with up to maxPieces (3 or 4) men into dir using the
+    // given number of threads (0 = hardware concurrency). Tables already in
+    // dir are reused. progress receives one line per table.
+    static bool generate(const std::string &dir, int threads, int maxPieces = 4,
+                         const std::function<void(const std::string &)> &progress = {});
+
+    // Canonical material signatures in generation order ("KQvK", ..., "KPvKP").
+    static std::vector<std::string> allMaterials(int maxPieces = 4);
+
+private:
+    struct Table {
+        int pieces = 0;
+        const uint8_t *wdl = nullptr;   // packed 2-bit entries (after header)
+        const uint8_t *dtz = nullptr;   // 1 byte per entry (after header)
+        void *wdlMap = nullptr;
+        void *dtzMap = nullptr;
+        std::size_t wdlMapSize = 0;
+        std::size_t dtzMapSize = 0;
+    };
+    std::map<std::string, Table> tables;
+    int maxLoadedPieces = 0;
+
+    bool loadTable(const std::string &dir, const std::string &name);
+    const Table *findTable(const std::string &name) const;
+
+    friend class TablebaseGenerator;
+};
+
+#endif
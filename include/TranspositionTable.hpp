@@ -0,0 +1,65 @@
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Transposition table keyed by AIPlayer::boardKey. Values are stored from the
+// side to move's point of view, so one table can be shared by players of
+// either colour and by several searches running at once. Implementations must
+// be thread-safe.
+class TranspositionTable {
+public:
+    // What value says about the position: its exact score, or only a limit
+    // on it when the search failed high (LOWER) or low (UPPER)
+    enum Bound : uint8_t { EXACT, LOWER, UPPER };
+    // The same bound seen from the other side (the value negated)
+    static Bound flip(Bound b) { return b == LOWER ? UPPER : b == UPPER ? LOWER : EXACT; }
+
+    struct Entry {
+        double value = 0.0;   // side to move's view
+        int depth = 0;        // depth at which value was computed
+        std::string bestMove; // best move found here ("" if none), used for the PV
+        Bound bound = EXACT;  // side to move's view, like value
+    };
+
+    TranspositionTable() = default;
+    virtual ~TranspositionTable() = default;
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    virtual bool probe(const std::string &key, Entry &out) const = 0;
+    virtual void store(const std::string &key, const Entry &entry) = 0;
+    virtual void clear() = 0;
+    virtual std::size_t size() const = 0;
+};
+
+// In-process table: a hash map split into shards, each behind its own mutex
+class LocalTranspositionTable : public TranspositionTable {
+public:
+    // maxEntries bounds the table (0 = unbounded); a full shard is cleared
+    explicit LocalTranspositionTable(std::size_t maxEntries = 0);
+
+    bool probe(const std::string &key, Entry &out) const override;
+    void store(const std::string &key, const Entry &entry) override;
+    void clear() override;
+    std::size_t size() const override;
+
+private:
+    static constexpr std::size_t SHARDS = 64;
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> map;
+    };
+    std::array<Shard, SHARDS> shards;
+    std::size_t maxPerShard;
+
+    Shard &shardFor(const std::string &key);
+    const Shard &shardFor(const std::string &key) const;
+};
+
+#endif
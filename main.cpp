@@ -1,5 +1,8 @@
 #include "Board.hpp"
 #include "AIPlayer.hpp"
+#include "Tablebase.hpp"
+#include "SharedTranspositionTable.hpp"
+#include "BotMCTS.hpp"
 #include <iostream>
 #include <string>
 #include <thread>
@@ -7,12 +10,138 @@
 #include <cctype>
 #include <vector>
 #include <fstream>
+#include <stop_token>
+#include <cstdlib>
+#include <memory>
+#include <iomanip>
+#include <cstdint>
+
+// Runs the AI's search in the background; 'q' + Enter stops it mid-search,
+// in which case the move from the last completed depth is played.
+static std::string aiMove(AIPlayer &ai, const Board &board, bool &quit) {
+    std::stop_source stop;
+    auto result = ai.startSearch(board, SearchLimits(), stop.get_token());
+    while (result.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready) {
+        if (!quit && std::cin.rdbuf()->in_avail() > 0) {
+            char c;
+            std::cin >> c;
+            if (c == 'q' || c == 'Q') {
+                quit = true;
+                stop.request_stop();
+            }
+        }
+    }
+    return result.get().bestMove;
+}
+
+// ChessAI bench [depth]: search a fixed set of positions to a fixed depth
+// with the random root bias off and fresh tables for each position. The
+// node counts then only change when the search itself changes; the
+// signature folds them (and the chosen moves) into one number to compare
+// between builds. NPS is the speed figure.
+static int runBench(int depth) {
+    static const char *BENCH_POSITIONS[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+        "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKR b - - 0 1",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    };
+
+    uint64_t totalNodes = 0;
+    double totalMs = 0.0;
+    uint64_t signature = 0xcbf29ce484222325ULL;
+    auto mix = [&signature](uint64_t v) {
+        signature ^= v;
+        signature *= 0x100000001b3ULL;
+    };
+
+    int index = 0;
+    for (const char *fen : BENCH_POSITIONS) {
+        Board board;
+        board.loadFEN(fen);
+        AIPlayer ai(board.getCurrentPlayer(), depth);
+        ai.setRandomBias(false);
+        SearchLimits limits;
+        limits.depth = depth;
+        SearchResult r = ai.runSearch(board, limits);
+
+        totalNodes += r.stats.nodes;
+        totalMs += r.stats.elapsedMs;
+        mix(r.stats.nodes);
+        for (char c : r.bestMove) mix(static_cast<unsigned char>(c));
+        std::cout << "Position " << ++index << ": " << std::setw(5) << r.bestMove << std::setw(10) << r.stats.nodes
+                  << " nodes" << std::setw(9) << static_cast<long long>(r.stats.elapsedMs) << " ms\n";
+    }
+
+    std::cout << "\nDepth:          " << depth
+              << "\nTotal time:     " << static_cast<long long>(totalMs) << " ms"
+              << "\nNodes searched: " << totalNodes
+              << "\nNodes/second:   " << static_cast<long long>(totalMs > 0 ? totalNodes * 1000.0 / totalMs : 0.0)
+              << "\nSignature:      " << std::hex << std::setw(16) << std::setfill('0') << signature << std::dec
+              << std::setfill(' ') << "\n";
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // ChessAI bench [depth]: fixed-depth search of fixed positions, no interaction
+    if (argc > 1 && std::string(argv[1]) == "bench") return runBench(argc > 2 ? std::max(1, std::atoi(argv[2])) : 3);
 
-int main() {
     Board board;
     AIPlayer aiWhite('W', 4);
     AIPlayer aiBlack('B', 4);
 
+    // Optional endgame tablebases: ChessAI --tb <dir>
+    // Optional search statistics, one JSON line per AI move: ChessAI --stats-log <file>
+    // Optional transposition table shared with other ChessAI processes:
+    //   ChessAI --shared-tt <name> [--hash-mb N] [--huge-pages]
+    // Optional Monte Carlo tree search engine instead of alpha-beta: ChessAI --mcts <ms per move>
+    Tablebase tablebase;
+    std::unique_ptr<BotMCTS> mctsWhite, mctsBlack;
+    std::ofstream statsLog;
+    std::string sharedName;
+    std::size_t hashMb = 256;
+    bool hugePages = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--huge-pages") hugePages = true;
+    }
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--shared-tt") sharedName = argv[i + 1];
+        if (std::string(argv[i]) == "--hash-mb") hashMb = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::string(argv[i]) == "--mcts") {
+            double ms = std::atof(argv[i + 1]);
+            mctsWhite = std::make_unique<BotMCTS>(0, ms);
+            mctsBlack = std::make_unique<BotMCTS>(0, ms);
+        }
+        if (std::string(argv[i]) == "--stats-log") {
+            statsLog.open(argv[i + 1], std::ios::app);
+            aiWhite.setStatsSink(&statsLog);
+            aiBlack.setStatsSink(&statsLog);
+        }
+        if (std::string(argv[i]) == "--tb") {
+            int loaded = tablebase.load(argv[i + 1]);
+            std::cout << "Loaded " << loaded << " tablebases from " << argv[i + 1] << "\n";
+            if (loaded > 0) {
+                aiWhite.setTablebase(&tablebase);
+                aiBlack.setTablebase(&tablebase);
+            }
+        }
+    }
+    if (!sharedName.empty()) {
+        auto shared = std::make_shared<SharedTranspositionTable>();
+        if (shared->attach(sharedName, hashMb, hugePages)) {
+            std::cout << "Using shared transposition table " << sharedName << " ("
+                      << shared->bucketCount() * 2 << " entries)\n";
+            aiWhite.setTranspositionTable(shared);
+            aiBlack.setTranspositionTable(shared);
+        } else {
+            std::cout << "Cannot attach shared transposition table " << sharedName << "\n";
+        }
+    }
+
     std::cout << "Select mode:\n";
     std::cout << "1. Player vs Player\n";
     std::cout << "2. Player (White) vs AI (Black)\n";
@@ -66,7 +195,12 @@ int main() {
                 std::cin >> move;
                 if (move == "q" || move == "Q") break;
             } else {
-                move = aiBlack.findBestMove(board);
+                bool quit = false;
+                move = mctsBlack ? mctsBlack->getMove(board, 'B') : aiMove(aiBlack, board, quit);
+                if (quit) {
+                    std::cout << "Quitting game...\n";
+                    break;
+                }
                 if (move.empty()) {
                     std::cout << "AI has no legal moves.\n";
                     break;
@@ -74,8 +208,13 @@ int main() {
             }
         }
         else if (mode == 3) { // AIvAI
-            move = (current == 'W') ? aiWhite.findBestMove(board)
-                                    : aiBlack.findBestMove(board);
+            bool quit = false;
+            if (mctsWhite) move = (current == 'W' ? mctsWhite : mctsBlack)->getMove(board, current);
+            else move = aiMove(current == 'W' ? aiWhite : aiBlack, board, quit);
+            if (quit) {
+                std::cout << "Quitting game...\n";
+                break;
+            }
             if (move.empty()) {
                 std::cout << "AI (" << current << ") has no legal moves.\n";
                 break;
@@ -87,10 +226,15 @@ int main() {
         std::chrono::duration<double> elapsed = aiEnd - aiStart;
 
         // Make move
-        if (!board.makeMove(move)) {
-            std::cout << "Invalid move, try again.\n";
+        std::string error = board.validateMove(move);
+        if (!error.empty()) {
+            std::cout << "Invalid move: " << error << " Try again.\n";
             continue; // Don't increment moveCount
         }
+        char movedPiece = board.getSquare(move[0] - 'a', '8' - move[1]);
+        bool promotion = std::toupper(static_cast<unsigned char>(movedPiece)) == 'P' &&
+                         (move[3] == '1' || move[3] == '8');
+        board.makeMove(move);
         moveHistory.push_back(move);
         moveCount++;
 
@@ -100,11 +244,33 @@ int main() {
         // Display board
         board.display();
 
+        if (promotion) std::cout << "Pawn promoted to Queen!\n";
+
         // Show AI info under board
-        if ((mode == 2 && current == 'B') || mode == 3) {
+        if (mctsWhite && ((mode == 2 && current == 'B') || mode == 3)) {
+            const BotMCTS::Stats &st = (current == 'W' ? mctsWhite : mctsBlack)->lastStats();
+            std::cout << "\n--- AI INFO (MCTS) ---\n";
+            std::cout << "AI (" << (current == 'W' ? "White" : "Black") << ") played: " << move << "\n";
+            std::cout << "Playouts: " << st.iterations << "   tree visits: " << st.rootVisits
+                      << " (" << st.reusedVisits << " reused)   win rate: "
+                      << static_cast<int>(st.winRate * 100) << "%\n";
+            std::cout << "AI thinking time: " << st.elapsedMs << " ms\n";
+        } else if ((mode == 2 && current == 'B') || mode == 3) {
+            const AIPlayer &ai = (current == 'W') ? aiWhite : aiBlack;
+            const SearchStats &st = ai.lastSearchStats();
             std::cout << "\n--- AI INFO ---\n";
             std::cout << "AI (" << (current == 'W' ? "White" : "Black") << ") played: " << move << "\n";
-            std::cout << "AI thinking time: " << elapsed.count() * 1000 << " ms\n";
+            std::cout << "Eval: " << st.baseScore << " -> " << st.score
+                      << "   depth " << (st.depths.empty() ? 0 : st.depths.back().depth) << "\n";
+            std::cout << "Nodes: " << st.nodes << "   NPS: " << static_cast<long long>(st.nps())
+                      << "   EBF: " << st.effectiveBranchingFactor() << "\n";
+            std::cout << "TT hits: " << static_cast<int>(st.ttHitRate() * 100) << "%   first-move cutoffs: "
+                      << static_cast<int>(st.firstMoveCutoffRate() * 100) << "%   eval cache hits: "
+                      << static_cast<int>(st.evalHitRate() * 100) << "%   pawn hash hits: "
+                      << static_cast<int>(st.pawnHitRate() * 100) << "%\n";
+            std::cout << "AI thinking time: " << elapsed.count() * 1000 << " ms"
+                      << (st.ponderHit ? " (ponder hit)" : "")
+                      << "   (average " << ai.averageThinkingMs() << " ms)\n";
         }
 
         // Check endgame
@@ -123,6 +289,9 @@ int main() {
             std::cout << (nextPlayer == 'W' ? "White" : "Black")
                       << " is in check!\n";
         }
+
+        // Let the AI think on the human's time
+        if (mode == 2 && current == 'B' && !mctsBlack) aiBlack.startPondering(board);
     }
 
     if (moveCount >= maxMoves) {
@@ -1,20 +1,30 @@
 #include "AIPlayer.hpp"
 #include "Board.hpp"
+#include "Tablebase.hpp"
+#include "MateSolver.hpp"
+#include "PawnStructure.hpp"
+#include "MovePicker.hpp"
+#include "Log.hpp"
 #include <vector>
 #include <cstdlib>
 #include <ctime>
 #include <cctype>
-#include <iostream>
+#include <ostream>
 #include <iomanip>
 #include <algorithm>
 #include <chrono>
 #include <limits>
 
 AIPlayer::AIPlayer(char color, int maxDepth_)
-    : playerColor(color), lastMoveFrom(""), maxDepth(maxDepth_) {
+    : playerColor(color), lastMoveFrom(""), maxDepth(maxDepth_), tt(std::make_shared<LocalTranspositionTable>()),
+      evalCache(std::make_shared<EvalCache>()), pawnHash(std::make_unique<PawnHash>()) {
     std::srand(std::time(nullptr));
 }
 
+AIPlayer::~AIPlayer() {
+    stopPondering();
+}
+
 // small piece values
 double AIPlayer::pieceValue(char piece) const {
     switch (std::toupper(static_cast<unsigned char>(piece))) {
@@ -76,105 +86,364 @@ double AIPlayer::evaluateBoard(const Board &board) const {
         }
     }
 
-    // return from AI's perspective (positive => good for AI)
-    return (playerColor == 'W') ? score : -score;
+    // pawn structure, cached by pawn key (White's view)
+    double pawns = pawnHash->probe(board);
+    score += (playerColor == 'W') ? pawns : -pawns;
+
+    // score is already from AI's perspective (positive => good for AI)
+    return score;
+}
+
+// Forget the killers and history of the previous search
+void AIPlayer::resetMoveOrdering() {
+    for (auto &k : killers) k = {};
+    for (auto &row : history) row.fill(0);
+}
+
+// evaluateBoard through the eval cache; the cache holds White's view so
+// players of either colour can share it
+double AIPlayer::staticEval(const Board &board) {
+    ++stats.evalProbes;
+    uint64_t key = board.zobristKey();
+    double white;
+    if (evalCache->probe(key, white)) {
+        ++stats.evalHits;
+        return playerColor == 'W' ? white : -white;
+    }
+    double score = evaluateBoard(board);
+    evalCache->store(key, playerColor == 'W' ? score : -score);
+    return score;
 }
 
 // Build a simple ASCII key for the board + side to move; OK for a TT prototype
 std::string AIPlayer::boardKey(const Board &board) const {
     std::string k;
-    k.reserve(65 + 1);
+    k.reserve(67 + 1);
     for (int y = 0; y < 8; ++y)
         for (int x = 0; x < 8; ++x)
             k.push_back(board.getSquare(x, y));
     k.push_back(board.getCurrentPlayer()); // side-to-move matters
+    // so do castling and en passant: the same squares can have different moves
+    int castling = board.whiteKingMoved | board.whiteRookMoved[0] << 1 | board.whiteRookMoved[1] << 2
+                 | board.blackKingMoved << 3 | board.blackRookMoved[0] << 4 | board.blackRookMoved[1] << 5;
+    k.push_back(static_cast<char>('0' + castling));
+    k.push_back(board.enPassantX >= 0 ? static_cast<char>('a' + board.enPassantX) : '-');
     return k;
 }
 
 // Generate all legal moves for given colour
 std::vector<std::string> AIPlayer::generateAllLegalMoves(Board &board, char color) const {
-    std::vector<std::string> moves;
-    for (int fromY=0; fromY<8; ++fromY) {
-        for (int fromX=0; fromX<8; ++fromX) {
-            char piece = board.getSquare(fromX, fromY);
-            if (piece == '.') continue;
-            if ((color=='W' && !std::isupper(static_cast<unsigned char>(piece))) ||
-                (color=='B' && !std::islower(static_cast<unsigned char>(piece)))) continue;
-
-            for (int toY=0; toY<8; ++toY) {
-                for (int toX=0; toX<8; ++toX) {
-                    std::string mv = std::string() + char('a'+fromX) + char('8'-fromY)
-                                     + char('a'+toX) + char('8'-toY);
-                    if (board.isMoveValid(mv)) moves.push_back(mv);
-                }
-            }
-        }
-    }
-    return moves;
+    if (color != board.getCurrentPlayer()) return {}; // only the side to move has legal moves
+    return board.legalMoves();
 }
 
-// Alpha-beta with TT and move ordering (captures first)
+// Alpha-beta with TT and staged move ordering
 double AIPlayer::alphaBeta(Board &board, int depth, double alpha, double beta, bool maximizing) {
-    // terminal or depth 0 => eval
-    if (depth == 0) return evaluateBoard(board);
-
-    // TT lookup
-    std::string key = boardKey(board);
-    auto it = tt.find(key);
-    if (it != tt.end() && it->second.depth >= depth) {
-        // cached value at same-or-deeper depth — use it
-        return it->second.value;
+    if (limitReached()) return 0.0; // caller discards it
+    ++stats.nodes;
+
+    // tablebase hit: the endgame is solved, no need to search it
+    int wdl;
+    if (tablebase && tablebase->probeWDL(board, wdl)) {
+        ++stats.tbHits;
+        double v = wdl * TB_WIN_SCORE; // side to move's view
+        return maximizing ? v : -v;
     }
 
-    char color = maximizing ? playerColor : (playerColor == 'W' ? 'B' : 'W');
-    std::vector<std::string> moves = generateAllLegalMoves(board, color);
-
-    if (moves.empty()) {
-        // no legal moves -> evaluate (checkmate/stalemate handled by isCheckmate/isStalemate elsewhere)
-        return evaluateBoard(board);
+    // terminal or depth 0 => eval
+    if (depth == 0) {
+        ++stats.qnodes;
+        return staticEval(board);
     }
 
-    // Move ordering: prefer captures (bigger captured piece first)
-    std::sort(moves.begin(), moves.end(), [&](const std::string &a, const std::string &b) {
-        char atarget = board.getSquare(a[2]-'a', '8'-a[3]);
-        char btarget = board.getSquare(b[2]-'a', '8'-b[3]);
-        double av = (atarget=='.') ? 0.0 : pieceValue(atarget);
-        double bv = (btarget=='.') ? 0.0 : pieceValue(btarget);
-        return av > bv; // higher capture value first
-    });
+    // TT lookup; entries are stored for the side to move, so at a minimizing
+    // node the value is negated and a lower bound becomes an upper one
+    std::string key = boardKey(board);
+    ++stats.ttProbes;
+    TranspositionTable::Entry entry;
+    std::string ttMove;
+    if (tt->probe(key, entry)) {
+        ++stats.ttHits;
+        if (entry.depth >= depth) {
+            // cached value at same-or-deeper depth — use it if its bound settles this window
+            double value = maximizing ? entry.value : -entry.value;
+            TranspositionTable::Bound bound = maximizing ? entry.bound : TranspositionTable::flip(entry.bound);
+            if (bound == TranspositionTable::EXACT
+                || (bound == TranspositionTable::LOWER && value >= beta)
+                || (bound == TranspositionTable::UPPER && value <= alpha)) {
+                ++stats.ttCutoffs;
+                return value;
+            }
+        }
+        ttMove = entry.bestMove;
+    }
+    const double alphaOrig = alpha, betaOrig = beta;
 
+    // Moves come in stages (hash move, captures, killers, quiets); later
+    // stages are only generated if no earlier move cut off
+    MovePicker picker(board, ttMove, killers[depth], history);
     double bestVal = maximizing ? -std::numeric_limits<double>::infinity()
                                 : std::numeric_limits<double>::infinity();
+    std::string bestMove;
+
+    std::string mv;
+    std::size_t searched = 0; // counted before the move, so a cutoff still counts it
+    while (picker.next(mv)) {
+        ++searched;
+        // small extra priority if the move is a capture to favor tactical win;
+        // the child's window is shifted by it so its bounds stay comparable
+        char captured = board.getSquare(mv[2]-'a', '8'-mv[3]);
+        double bonus = captured != '.' ? (maximizing ? 1.0 : -1.0) * pieceValue(captured) * 0.25 : 0.0;
 
-    for (const std::string &mv : moves) {
         Board copy = board;
         copy.makeMove(mv);
-        double val = alphaBeta(copy, depth - 1, alpha, beta, !maximizing);
-
-        // small extra priority if the move is a capture to favor tactical win
-        char captured = board.getSquare(mv[2]-'a', '8'-mv[3]);
-        if (captured != '.') {
-            val += (maximizing ? 1.0 : -1.0) * pieceValue(captured) * 0.25;
-        }
+        double val = alphaBeta(copy, depth - 1, alpha - bonus, beta - bonus, !maximizing) + bonus;
 
         if (maximizing) {
-            if (val > bestVal) bestVal = val;
+            if (val > bestVal) { bestVal = val; bestMove = mv; }
             alpha = std::max(alpha, val);
         } else {
-            if (val < bestVal) bestVal = val;
+            if (val < bestVal) { bestVal = val; bestMove = mv; }
             beta = std::min(beta, val);
         }
-        if (beta <= alpha) break; // alpha-beta cut
+        if (beta <= alpha) { // alpha-beta cut
+            ++stats.betaCutoffs;
+            if (searched == 1) ++stats.firstMoveCutoffs;
+            if (MovePicker::isQuiet(board, mv)) {
+                // remember quiet cutoff moves for siblings (killers) and everywhere (history)
+                MovePicker::Killers &k = killers[depth];
+                if (k[0] != mv) {
+                    k[1] = k[0];
+                    k[0] = mv;
+                }
+                history[MovePicker::square(mv[0], mv[1])][MovePicker::square(mv[2], mv[3])] += depth * depth;
+            }
+            break;
+        }
     }
 
-    // store in TT
-    tt[key] = { bestVal, depth };
+    if (searched == 0) {
+        // no legal moves -> evaluate (checkmate/stalemate handled by isCheckmate/isStalemate elsewhere)
+        return staticEval(board);
+    }
+
+    // store in TT (unless the search was stopped underneath us)
+    if (stopRequested.load(std::memory_order_relaxed)) return bestVal;
+    TranspositionTable::Bound bound = bestVal <= alphaOrig ? TranspositionTable::UPPER
+                                    : bestVal >= betaOrig  ? TranspositionTable::LOWER
+                                                           : TranspositionTable::EXACT;
+    tt->store(key, { maximizing ? bestVal : -bestVal, depth, bestMove, maximizing ? bound : TranspositionTable::flip(bound) });
     return bestVal;
 }
 
-// Iterative deepening + alpha-beta search driver
+// Pick the root move straight from the tablebase: win with the shortest
+// distance to zeroing, otherwise hold the draw, otherwise resist longest.
+bool AIPlayer::tablebaseRootMove(Board &board, const std::vector<std::string> &moves,
+                                 std::string &best, int &wdl) const {
+    if (!tablebase || !tablebase->probeWDL(board, wdl)) return false;
+
+    int bestRank = std::numeric_limits<int>::min();
+    for (const std::string &mv : moves) {
+        char moving = board.getSquare(mv[0]-'a', '8'-mv[1]);
+        bool zeroing = std::toupper(static_cast<unsigned char>(moving)) == 'P' ||
+                       board.getSquare(mv[2]-'a', '8'-mv[3]) != '.';
+
+        Board copy = board;
+        copy.makeMove(mv);
+        int childWdl, childDtz;
+        if (!tablebase->probe(copy, childWdl, childDtz)) return false;
+
+        int dtz = zeroing ? 1 : childDtz + 1;
+        int rank;
+        if (childWdl == Tablebase::TB_LOSS && childDtz == 0) rank = 1000; // mate
+        else if (childWdl == Tablebase::TB_LOSS) rank = 1000 - dtz;   // we win: be quick
+        else if (childWdl == Tablebase::TB_DRAW) rank = 0;
+        else rank = -1000 + dtz;                                // we lose: be slow
+        if (rank > bestRank) {
+            bestRank = rank;
+            best = mv;
+        }
+    }
+    return !best.empty();
+}
+
+// Public entry point: synchronous search with the player's own depth
 std::string AIPlayer::findBestMove(Board& board) {
+    return think(board, SearchLimits(), std::stop_token(), infoCallback);
+}
+
+// Asynchronous search: runs on its own thread until the limits are reached or
+// stop is requested, reporting every completed depth through onInfo
+std::future<SearchResult> AIPlayer::startSearch(const Board &board, SearchLimits limits, std::stop_token stop,
+                                                std::function<void(const SearchInfo &)> onInfo) {
+    return std::async(std::launch::async, [this, board, limits, stop, onInfo]() {
+        return runSearch(board, limits, stop, onInfo);
+    });
+}
+
+SearchResult AIPlayer::runSearch(const Board &board, const SearchLimits &limits, std::stop_token stop,
+                                 const std::function<void(const SearchInfo &)> &onInfo) {
+    Board pos = board;
+    SearchResult result;
+    result.bestMove = think(pos, limits, stop, onInfo ? onInfo : infoCallback);
+    result.score = stats.score;
+    result.pv = stats.pv;
+    result.lines = stats.lines;
+    result.stopped = stats.stopped;
+    result.stats = stats;
+    return result;
+}
+
+// Picks up or discards a running ponder search, then searches
+std::string AIPlayer::think(Board &board, const SearchLimits &limits, std::stop_token stop,
+                            const std::function<void(const SearchInfo &)> &onInfo) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    std::string move;
+    if (ponderThread.joinable()) {
+        bool hit = ponderBoard.toFEN() == board.toFEN();
+        if (!hit) ponderThread.request_stop();
+        {
+            // on a hit the ponder search runs on to full depth unless we are stopped
+            std::stop_callback forward(stop, [this] { ponderThread.request_stop(); });
+            ponderThread.join();
+        }
+        if (hit && !ponderResult.empty()) {
+            move = ponderResult;
+            stats.ponderHit = true;
+        }
+        LOG_DEBUG("[PONDER] " << (hit ? "hit" : "miss"));
+    }
+    if (move.empty()) move = search(board, limits, stop, onInfo);
+
+    finishMove(move, t0);
+    return move;
+}
+
+// Book-keeping shared by the synchronous and asynchronous entry points
+void AIPlayer::finishMove(const std::string &move, std::chrono::high_resolution_clock::time_point t0) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - t0;
+    totalThinkingTime += elapsed.count();
+    movesCount++;
+
+    // update lastMoveFrom for repetition avoidance
+    if (!move.empty()) lastMoveFrom = move.substr(0,2);
+
+    if (statsSink) {
+        stats.writeJson(*statsSink);
+        *statsSink << "\n";
+        statsSink->flush();
+    }
+}
+
+void AIPlayer::startPondering(const Board &board) {
+    stopPondering();
+
+    // Expected reply = second PV move, i.e. the TT best move after our move
+    TranspositionTable::Entry entry;
+    if (!tt->probe(boardKey(board), entry) || entry.bestMove.empty() || !board.isMoveValid(entry.bestMove)) return;
+
+    ponderBoard = board;
+    ponderBoard.makeMove(entry.bestMove);
+    ponderResult.clear();
+    LOG_DEBUG("[PONDER] expecting " << entry.bestMove);
+    ponderThread = std::jthread([this](std::stop_token stop) {
+        ponderResult = search(ponderBoard, SearchLimits(), stop, infoCallback);
+    });
+}
+
+void AIPlayer::stopPondering() {
+    if (!ponderThread.joinable()) return;
+    ponderThread.request_stop();
+    ponderThread.join();
+}
+
+// Checked at every node: stop request, node budget, time budget
+bool AIPlayer::limitReached() {
+    if (stopRequested.load(std::memory_order_relaxed)) return true;
+    bool over = (activeLimits.nodes && stats.nodes >= activeLimits.nodes);
+    if (!over && activeLimits.movetimeMs > 0) {
+        std::chrono::duration<double, std::milli> used = std::chrono::high_resolution_clock::now() - searchStart;
+        over = used.count() >= activeLimits.movetimeMs;
+    }
+    if (over) stopRequested = true;
+    return over;
+}
+
+// Follow TT best moves from the root to recover the principal variation
+std::vector<std::string> AIPlayer::principalVariation(const Board &board, std::string first, int maxLength) const {
+    std::vector<std::string> pv;
+    Board pos = board;
+    std::string mv = std::move(first);
+    while (!mv.empty() && static_cast<int>(pv.size()) < maxLength && pos.isMoveValid(mv)) {
+        pv.push_back(mv);
+        pos.makeMove(mv);
+        TranspositionTable::Entry entry;
+        mv = tt->probe(boardKey(pos), entry) ? entry.bestMove : "";
+    }
+    return pv;
+}
+
+// Full-window value of one root move, searched to depth plies including the move
+double AIPlayer::rootMoveValue(const Board &board, const std::string &mv, int depth) {
+    Board copy = board;
+    copy.makeMove(mv);
+
+    double val = alphaBeta(copy, depth - 1,
+                           -std::numeric_limits<double>::infinity(),
+                            std::numeric_limits<double>::infinity(),
+                           false);
+
+    // extra capture bonus on top-level
+    char captured = board.getSquare(mv[2]-'a', '8'-mv[3]);
+    if (captured != '.') val += pieceValue(captured) * 0.4;
+    return val;
+}
+
+// One root move on its own, without the random root bias; the unit of work
+// when the root is split across processes
+bool AIPlayer::searchRootMove(const Board &board, const std::string &move, int depth, double &score,
+                              std::stop_token stop) {
+    stats = SearchStats();
+    stats.color = playerColor;
+    searchStart = std::chrono::high_resolution_clock::now();
+    activeLimits = SearchLimits();
+    stopRequested = false;
+    std::stop_callback onStop(stop, [this] { stopRequested = true; });
+    pawnHash->resetCounters();
+    resetMoveOrdering();
+
+    if (board.getCurrentPlayer() != playerColor || !board.isMoveValid(move)) return false;
+    ++stats.nodes;
+    score = rootMoveValue(board, move, std::clamp(depth, 1, MAX_SEARCH_DEPTH));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - searchStart;
+    stats.elapsedMs = elapsed.count();
+    stats.stopped = stopRequested.load(std::memory_order_relaxed);
+    stats.pawnProbes = pawnHash->probes;
+    stats.pawnHits = pawnHash->hits;
+    return !stats.stopped;
+}
+
+// Iterative deepening + alpha-beta search driver
+std::string AIPlayer::search(Board& board, const SearchLimits &limits, std::stop_token stop,
+                             const std::function<void(const SearchInfo &)> &onInfo) {
     auto t0 = std::chrono::high_resolution_clock::now();
+    stats = SearchStats();
+    stats.color = playerColor;
+
+    // Stop requests and limits all end up in stopRequested
+    searchStart = t0;
+    activeLimits = limits;
+    stopRequested = false;
+    std::stop_callback onStop(stop, [this] { stopRequested = true; });
+    pawnHash->resetCounters();
+    resetMoveOrdering();
+
+    // never deeper than the per-depth move ordering tables reach
+    int depthLimit = limits.depth > 0 ? limits.depth
+                   : (limits.movetimeMs > 0 || limits.nodes > 0) ? MAX_SEARCH_DEPTH : maxDepth;
+    depthLimit = std::min(depthLimit, MAX_SEARCH_DEPTH);
+    int multiPV = std::max(1, limits.multiPV);
 
     // clear TT each move (optional) — keeping TT gives cross-depth reuse; we keep it.
     // tt.clear();
@@ -182,12 +451,32 @@ std::string AIPlayer::findBestMove(Board& board) {
     std::vector<std::string> legalMoves = generateAllLegalMoves(board, playerColor);
     if (legalMoves.empty()) return "";
 
+    // Solved endgame: play the tablebase move without searching
+    std::string tbMove;
+    int tbWdl;
+    if (tablebaseRootMove(board, legalMoves, tbMove, tbWdl)) {
+        ++stats.tbHits;
+        stats.score = tbWdl * TB_WIN_SCORE;
+        stats.bestMove = tbMove;
+        stats.pv = { tbMove };
+        stats.lines = { { tbMove, stats.score, stats.pv } };
+        LOG_DEBUG("[TB] best=" << tbMove << " wdl=" << tbWdl);
+        return tbMove;
+    }
+
+    // Forcing root: a proven mate needs no further search
+    if (mateRootMove(board, legalMoves, stop)) return stats.bestMove;
+
     double baseScore = evaluateBoard(board);
+    stats.baseScore = baseScore;
     std::string bestOverall = legalMoves.front();
     double bestOverallScore = -std::numeric_limits<double>::infinity();
 
     // Iterative deepening
-    for (int depth = 1; depth <= maxDepth; ++depth) {
+    for (int depth = 1; depth <= depthLimit; ++depth) {
+        auto depthStart = std::chrono::high_resolution_clock::now();
+        uint64_t nodesBefore = stats.nodes;
+        ++stats.nodes; // the root itself
         std::string bestAtDepth = "";
         double bestScoreAtDepth = -std::numeric_limits<double>::infinity();
 
@@ -200,66 +489,152 @@ std::string AIPlayer::findBestMove(Board& board) {
             return av > bv;
         });
 
+        std::vector<PVLine> scored; // every root move, for MultiPV
         for (const std::string &mv : legalMoves) {
-            Board copy = board;
-            copy.makeMove(mv);
+            double val = rootMoveValue(board, mv, depth);
+            if (multiPV > 1 && !stopRequested.load(std::memory_order_relaxed)) scored.push_back({ mv, val, {} });
 
-            double val = alphaBeta(copy, depth - 1,
-                                   -std::numeric_limits<double>::infinity(),
-                                    std::numeric_limits<double>::infinity(),
-                                   false);
-
-            // extra capture bonus on top-level
-            char captured = board.getSquare(mv[2]-'a', '8'-mv[3]);
-            if (captured != '.') val += pieceValue(captured) * 0.4;
-
-            // slight randomness / bias to diversify
-            char movingPiece = board.getSquare(mv[0]-'a', '8'-mv[1]);
+            // slight randomness / bias to diversify (not when analysing or
+            // when the bias is off)
+            char movingPiece = multiPV > 1 || !randomBias ? '.' : board.getSquare(mv[0]-'a', '8'-mv[1]);
+            auto chance = [](int percent) { return (std::rand()%100) < percent; };
             double bias = 0.0;
             switch (std::toupper(static_cast<unsigned char>(movingPiece))) {
-                case 'P': bias = ((std::rand()%100) < 18) ? 0.12 : 0.0; break;
-                case 'N': bias = ((std::rand()%100) < 12) ? 0.16 : 0.0; break;
-                case 'B': bias = ((std::rand()%100) < 8)  ? 0.16 : 0.0; break;
-                case 'R': bias = ((std::rand()%100) < 5)  ? 0.20 : 0.0; break;
-                case 'Q': bias = ((std::rand()%100) < 3)  ? 0.25 : 0.0; break;
+                case 'P': bias = chance(18) ? 0.12 : 0.0; break;
+                case 'N': bias = chance(12) ? 0.16 : 0.0; break;
+                case 'B': bias = chance(8)  ? 0.16 : 0.0; break;
+                case 'R': bias = chance(5)  ? 0.20 : 0.0; break;
+                case 'Q': bias = chance(3)  ? 0.25 : 0.0; break;
                 case 'K': bias = -0.9; break;
             }
             val += bias;
 
+            if (stopRequested.load(std::memory_order_relaxed)) break;
             if (val > bestScoreAtDepth) {
                 bestScoreAtDepth = val;
                 bestAtDepth = mv;
             }
         }
 
+        // a stopped iteration is incomplete; keep the previous depth's answer
+        // (or, if even depth 1 did not finish, the best of the moves it did search)
+        if (stopRequested.load(std::memory_order_relaxed)) {
+            stats.stopped = true;
+            if (stats.depths.empty() && !bestAtDepth.empty()) {
+                bestOverall = bestAtDepth;
+                bestOverallScore = bestScoreAtDepth;
+                stats.pv = { bestAtDepth };
+                stats.lines = { { bestAtDepth, bestScoreAtDepth, stats.pv } };
+            }
+            break;
+        }
+
         if (!bestAtDepth.empty()) {
             bestOverall = bestAtDepth;
             bestOverallScore = bestScoreAtDepth;
         }
 
-        // small console feedback per depth
-        std::cout << "[ID] depth=" << depth << " best=" << bestAtDepth
-                  << " score=" << std::fixed << std::setprecision(2) << bestScoreAtDepth << "\n";
-    }
+        stats.pv = principalVariation(board, bestOverall, depth);
+
+        // Root moves are searched with a full window and the TT only answers
+        // with bounds that hold, so every root score is exact and the top N
+        // lines come for free; only their PVs are extra
+        if (multiPV > 1) {
+            std::stable_sort(scored.begin(), scored.end(),
+                             [](const PVLine &a, const PVLine &b) { return a.score > b.score; });
+            scored.resize(std::min<std::size_t>(scored.size(), multiPV));
+            for (PVLine &line : scored) line.pv = principalVariation(board, line.move, depth);
+            stats.lines = std::move(scored);
+        } else {
+            stats.lines = { { bestOverall, bestOverallScore, stats.pv } };
+        }
 
-    auto t1 = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = t1 - t0;
+        // per-depth record
+        auto now = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> depthTime = now - depthStart;
+        std::chrono::duration<double, std::milli> soFar = now - t0;
+        stats.depths.push_back({ depth, stats.nodes - nodesBefore, depthTime.count(), bestAtDepth, bestScoreAtDepth });
 
-    totalThinkingTime += elapsed.count();
-    movesCount++;
+        LOG_DEBUG("[ID] depth=" << depth << " best=" << bestAtDepth << " score=" << bestScoreAtDepth
+                  << " nodes=" << stats.depths.back().nodes);
 
-    // update lastMoveFrom for repetition avoidance
-    if (!bestOverall.empty()) lastMoveFrom = bestOverall.substr(0,2);
-
-    // Debug output (kept concise so board display doesn't drown it)
-    std::cout << "\n========== AI DEBUG INFO ==========\n";
-    std::cout << "AI Colour: " << (playerColor=='W' ? "White" : "Black") << "\n";
-    std::cout << "Base Score: " << std::fixed << std::setprecision(2) << baseScore << "\n";
-    std::cout << "Chosen Move: " << bestOverall << "   (depth " << maxDepth << ")\n";
-    std::cout << "Eval (post-search): " << std::fixed << std::setprecision(2) << bestOverallScore << "\n";
-    std::cout << "Thinking Time: " << (elapsed.count()*1000.0) << " ms\n";
-    std::cout << "Average Time: " << ((movesCount>0) ? (totalThinkingTime/movesCount*1000.0) : 0.0) << " ms\n";
-    std::cout << "===================================\n\n";
+        if (onInfo) onInfo({ depth, bestOverall, bestOverallScore, stats.pv, stats.nodes, soFar.count(), stats.lines });
+    }
 
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - t0;
+    stats.bestMove = bestOverall;
+    stats.score = bestOverallScore;
+    stats.elapsedMs = elapsed.count();
+    stats.pawnProbes = pawnHash->probes;
+    stats.pawnHits = pawnHash->hits;
     return bestOverall;
 }
+
+double SearchStats::effectiveBranchingFactor() const {
+    if (depths.size() < 2 || depths[depths.size() - 2].nodes == 0) return 0.0;
+    return double(depths.back().nodes) / depths[depths.size() - 2].nodes;
+}
+
+void AIPlayer::setMateSearch(uint64_t nodes, int maxMoves) {
+    mateNodes = nodes;
+    mateMoves = std::max(1, maxMoves);
+}
+
+// Run the mate solver when at least one root move gives check; on a proven
+// mate fill in the stats as a finished search would
+bool AIPlayer::mateRootMove(const Board &board, const std::vector<std::string> &legalMoves, std::stop_token stop) {
+    if (mateNodes == 0) return false;
+    bool forcing = std::any_of(legalMoves.begin(), legalMoves.end(), [&](const std::string &mv) {
+        Board next = board;
+        next.makeMove(mv);
+        return next.isInCheck(next.getCurrentPlayer());
+    });
+    if (!forcing) return false;
+
+    if (!mateSolver) mateSolver = std::make_unique<MateSolver>(1u << 18);
+    MateSolver::Result r = mateSolver->solve(board, mateMoves, mateNodes, stop);
+    stats.mateNodes = r.nodes;
+    LOG_DEBUG("[MATE] mate=" << r.mate << " in=" << r.mateIn << " nodes=" << r.nodes);
+    if (!r.mate || r.move.empty()) return false;
+
+    stats.score = MATE_SCORE - r.mateIn;
+    stats.bestMove = r.move;
+    stats.pv = r.pv;
+    stats.lines = { { r.move, stats.score, r.pv } };
+    return true;
+}
+
+void SearchStats::writeJson(std::ostream &out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "{\"color\":\"" << color << "\",\"move\":\"" << bestMove << "\",\"pv\":\"";
+    for (std::size_t i = 0; i < pv.size(); ++i) out << (i ? " " : "") << pv[i];
+    out << "\",\"score\":" << score
+        << ",\"base_score\":" << baseScore
+        << ",\"nodes\":" << nodes << ",\"qnodes\":" << qnodes
+        << ",\"tt_probes\":" << ttProbes << ",\"tt_hits\":" << ttHits << ",\"tt_cutoffs\":" << ttCutoffs
+        << ",\"eval_probes\":" << evalProbes << ",\"eval_hits\":" << evalHits
+        << ",\"pawn_probes\":" << pawnProbes << ",\"pawn_hits\":" << pawnHits
+        << ",\"beta_cutoffs\":" << betaCutoffs << ",\"first_move_cutoffs\":" << firstMoveCutoffs
+        << ",\"tb_hits\":" << tbHits << ",\"mate_nodes\":" << mateNodes << ",\"stopped\":" << (stopped ? "true" : "false") << ",\"ponder_hit\":" << (ponderHit ? "true" : "false") << ",\"ebf\":" << effectiveBranchingFactor()
+        << ",\"nps\":" << nps() << ",\"time_ms\":" << elapsedMs << ",\"depths\":[";
+    for (std::size_t i = 0; i < depths.size(); ++i) {
+        const Depth &d = depths[i];
+        out << (i ? "," : "") << "{\"depth\":" << d.depth << ",\"nodes\":" << d.nodes
+            << ",\"time_ms\":" << d.elapsedMs << ",\"best\":\"" << d.bestMove << "\",\"score\":" << d.score << "}";
+    }
+    out << "]";
+    if (lines.size() > 1) {
+        out << ",\"multipv\":[";
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            out << (i ? "," : "") << "{\"move\":\"" << lines[i].move << "\",\"score\":" << lines[i].score << ",\"pv\":\"";
+            for (std::size_t j = 0; j < lines[i].pv.size(); ++j) out << (j ? " " : "") << lines[i].pv[j];
+            out << "\"}";
+        }
+        out << "]";
+    }
+    out << "}";
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -1,10 +1,48 @@
 #include "Board.hpp"
 #include "AIPlayer.hpp"
+#include "Log.hpp"
 #include <cctype>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <vector>
 #include <iostream>
+#include <sstream>
+
+namespace {
+
+// Fixed pseudo-random Zobrist numbers, one per piece type and square
+struct ZobristTable {
+    std::array<std::array<uint64_t, 64>, 12> piece;
+    uint64_t blackToMove;
+    std::array<uint64_t, 6> castling;   // white king, white rooks a/h, black king, black rooks a/h moved
+    std::array<uint64_t, 8> epFile;
+
+    ZobristTable() {
+        uint64_t seed = 0x9e3779b97f4a7c15ULL;
+        auto next = [&seed] {
+            // splitmix64
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        };
+        for (auto &squares : piece)
+            for (uint64_t &v : squares) v = next();
+        blackToMove = next();
+        for (uint64_t &v : castling) v = next();
+        for (uint64_t &v : epFile) v = next();
+    }
+
+    static int index(char p) {
+        const char *pieces = "PNBRQKpnbrqk";
+        return static_cast<int>(std::strchr(pieces, p) - pieces);
+    }
+};
+
+const ZobristTable zobrist;
+
+} // namespace
 
 // Constructor: set up initial chessboard, current player, and last move
 Board::Board() : currentPlayer('W'), lastMove(""), enPassantX(-1), enPassantY(-1) {
@@ -24,6 +62,150 @@ Board::Board() : currentPlayer('W'), lastMove(""), enPassantX(-1), enPassantY(-1
             squares[y][x] = initial[y][x];
 }
 
+// Load a position from FEN: "<placement> <side> <castling> <ep> [<halfmove> <fullmove>]"
+bool Board::loadFEN(const std::string &fen) {
+    std::istringstream in(fen);
+    std::string placement, side, castling, ep;
+    if (!(in >> placement >> side >> castling >> ep)) return false;
+
+    Board b = *this;
+    int x = 0, y = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (x != 8) return false;
+            ++y; x = 0;
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            for (int i = 0; i < c - '0'; ++i) {
+                if (x > 7 || y > 7) return false;
+                b.squares[y][x++] = '.';
+            }
+        } else if (std::strchr("PNBRQKpnbrqk", c)) {
+            if (x > 7 || y > 7) return false;
+            b.squares[y][x++] = c;
+        } else {
+            return false;
+        }
+    }
+    if (x != 8 || y != 7) return false;
+
+    if (side != "w" && side != "b") return false;
+    b.currentPlayer = (side == "w") ? 'W' : 'B';
+
+    // Castling rights map onto the king/rook moved flags
+    if (castling != "-" && castling.find_first_not_of("KQkq") != std::string::npos) return false;
+    auto has = [&](char c) { return castling.find(c) != std::string::npos; };
+    b.whiteRookMoved[1] = !has('K');
+    b.whiteRookMoved[0] = !has('Q');
+    b.blackRookMoved[1] = !has('k');
+    b.blackRookMoved[0] = !has('q');
+    b.whiteKingMoved = !has('K') && !has('Q');
+    b.blackKingMoved = !has('k') && !has('q');
+
+    if (ep == "-") {
+        b.enPassantX = b.enPassantY = -1;
+    } else {
+        if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || (ep[1] != '3' && ep[1] != '6')) return false;
+        b.enPassantX = fileToX(ep[0]);
+        b.enPassantY = rankToY(ep[1]);
+    }
+
+    b.halfmoveClock = 0;
+    b.fullmoveNumber = 1;
+    in >> b.halfmoveClock >> b.fullmoveNumber; // optional (EPD omits them)
+    b.lastMove = "";
+
+    *this = b;
+    return true;
+}
+
+std::string Board::toFEN() const {
+    std::string fen;
+    for (int y = 0; y < 8; ++y) {
+        int empty = 0;
+        for (int x = 0; x < 8; ++x) {
+            if (squares[y][x] == '.') { ++empty; continue; }
+            if (empty) fen += char('0' + empty);
+            empty = 0;
+            fen += squares[y][x];
+        }
+        if (empty) fen += char('0' + empty);
+        if (y < 7) fen += '/';
+    }
+
+    fen += (currentPlayer == 'W') ? " w " : " b ";
+
+    // Only report rights that could still be used (king and rook at home)
+    std::string castling;
+    if (!whiteKingMoved && squares[7][4] == 'K') {
+        if (!whiteRookMoved[1] && squares[7][7] == 'R') castling += 'K';
+        if (!whiteRookMoved[0] && squares[7][0] == 'R') castling += 'Q';
+    }
+    if (!blackKingMoved && squares[0][4] == 'k') {
+        if (!blackRookMoved[1] && squares[0][7] == 'r') castling += 'k';
+        if (!blackRookMoved[0] && squares[0][0] == 'r') castling += 'q';
+    }
+    fen += castling.empty() ? "-" : castling;
+
+    fen += ' ';
+    if (enPassantX == -1) fen += '-';
+    else { fen += char('a' + enPassantX); fen += char('8' - enPassantY); }
+
+    fen += ' ' + std::to_string(halfmoveClock) + ' ' + std::to_string(fullmoveNumber);
+    return fen;
+}
+
+// SAN -> coordinate move by matching the target square (and any disambiguation)
+// against the legal moves of the side to move
+std::string Board::moveFromSAN(const std::string &sanIn) const {
+    std::string san;
+    for (char c : sanIn)
+        if (!std::strchr("+#!?", c)) san += c;
+
+    int homeRank = (currentPlayer == 'W') ? 1 : 8;
+    std::string home = std::string("e") + char('0' + homeRank);
+    if (san == "O-O" || san == "0-0")
+        return isMoveValid(home + "g" + char('0' + homeRank)) ? home + "g" + char('0' + homeRank) : "";
+    if (san == "O-O-O" || san == "0-0-0")
+        return isMoveValid(home + "c" + char('0' + homeRank)) ? home + "c" + char('0' + homeRank) : "";
+
+    // Promotion suffix ("e8=Q" / "e8Q"): the engine always promotes to a queen
+    std::size_t eq = san.find('=');
+    if (eq != std::string::npos) san = san.substr(0, eq);
+    else if (san.size() > 2 && std::strchr("QRBN", san.back()) && std::isdigit(static_cast<unsigned char>(san[san.size() - 2])))
+        san.pop_back();
+    if (san.size() < 2) return "";
+
+    char pieceType = 'P';
+    std::size_t start = 0;
+    if (std::strchr("KQRBN", san[0])) { pieceType = san[0]; start = 1; }
+
+    std::string target = san.substr(san.size() - 2);
+    if (target[0] < 'a' || target[0] > 'h' || target[1] < '1' || target[1] > '8') return "";
+
+    // Whatever sits between piece letter and target: disambiguation and/or 'x'
+    int fromFile = -1, fromRank = -1;
+    for (std::size_t i = start; i + 2 < san.size(); ++i) {
+        char c = san[i];
+        if (c >= 'a' && c <= 'h') fromFile = c - 'a';
+        else if (c >= '1' && c <= '8') fromRank = rankToY(c);
+        else if (c != 'x') return "";
+    }
+
+    std::string found;
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            char p = squares[y][x];
+            if (p == '.' || !isCorrectPlayerMove(p) || std::toupper(p) != pieceType) continue;
+            if ((fromFile != -1 && x != fromFile) || (fromRank != -1 && y != fromRank)) continue;
+            std::string mv = std::string() + char('a' + x) + char('8' - y) + target;
+            if (!isMoveValid(mv)) continue;
+            if (!found.empty()) return ""; // ambiguous
+            found = mv;
+        }
+    }
+    return found;
+}
+
 // Display board (white bottom). Uses Unicode chess glyphs for readability.
 void Board::display() const {
     std::cout << "\033[2J\033[1;1H"; // clear screen
@@ -242,6 +424,108 @@ std::string Board::validateMove(const std::string &move) const {
     return "";
 }
 
+uint64_t Board::pawnKey() const {
+    uint64_t key = 0;
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x) {
+            char p = squares[y][x];
+            if (p == 'P' || p == 'p') key ^= zobrist.piece[ZobristTable::index(p)][y * 8 + x];
+        }
+    return key;
+}
+
+uint64_t Board::zobristKey() const {
+    uint64_t key = 0;
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x) {
+            char p = squares[y][x];
+            if (p != '.') key ^= zobrist.piece[ZobristTable::index(p)][y * 8 + x];
+        }
+    if (currentPlayer == 'B') key ^= zobrist.blackToMove;
+    const bool moved[6] = { whiteKingMoved, whiteRookMoved[0], whiteRookMoved[1],
+                            blackKingMoved, blackRookMoved[0], blackRookMoved[1] };
+    for (int i = 0; i < 6; ++i)
+        if (moved[i]) key ^= zobrist.castling[i];
+    if (enPassantX >= 0) key ^= zobrist.epFile[enPassantX];
+    return key;
+}
+
+std::vector<std::string> Board::legalMoves() const {
+    return generateMoves(true, true);
+}
+
+std::vector<std::string> Board::legalCaptures() const {
+    return generateMoves(true, false);
+}
+
+std::vector<std::string> Board::legalQuiets() const {
+    return generateMoves(false, true);
+}
+
+// Captures (en passant included) and queen promotions count as tactical
+bool Board::isTactical(int fromX, int fromY, int toX, int toY) const {
+    if (squares[toY][toX] != '.') return true;
+    if (std::toupper(static_cast<unsigned char>(squares[fromY][fromX])) != 'P') return false;
+    return toX != fromX || toY == 0 || toY == 7;
+}
+
+std::vector<std::string> Board::generateMoves(bool tactical, bool quiet) const {
+    static const int knight[8][2] = { {1,2},{2,1},{2,-1},{1,-2},{-1,-2},{-2,-1},{-2,1},{-1,2} };
+    static const int king[8][2] = { {1,0},{1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1} };
+
+    std::vector<std::string> moves;
+    for (int fromY = 0; fromY < 8; ++fromY) {
+        for (int fromX = 0; fromX < 8; ++fromX) {
+            char piece = squares[fromY][fromX];
+            if (piece == '.' || !isCorrectPlayerMove(piece)) continue;
+
+            // Mark the squares this piece's movement pattern can reach
+            bool target[8][8] = {};
+            auto mark = [&](int x, int y) { if (x >= 0 && x < 8 && y >= 0 && y < 8) target[y][x] = true; };
+            auto slide = [&](int dx, int dy) {
+                for (int x = fromX + dx, y = fromY + dy; x >= 0 && x < 8 && y >= 0 && y < 8; x += dx, y += dy) {
+                    target[y][x] = true;
+                    if (squares[y][x] != '.') break;
+                }
+            };
+            switch (std::toupper(static_cast<unsigned char>(piece))) {
+                case 'P': {
+                    int dir = std::isupper(static_cast<unsigned char>(piece)) ? -1 : 1;
+                    mark(fromX, fromY + dir);
+                    mark(fromX, fromY + 2 * dir);
+                    mark(fromX - 1, fromY + dir);
+                    mark(fromX + 1, fromY + dir);
+                    break;
+                }
+                case 'N':
+                    for (auto &d : knight) mark(fromX + d[0], fromY + d[1]);
+                    break;
+                case 'K':
+                    for (auto &d : king) mark(fromX + d[0], fromY + d[1]);
+                    mark(fromX + 2, fromY); // castling
+                    mark(fromX - 2, fromY);
+                    break;
+                case 'B': slide(1, 1); slide(1, -1); slide(-1, 1); slide(-1, -1); break;
+                case 'R': slide(1, 0); slide(-1, 0); slide(0, 1); slide(0, -1); break;
+                case 'Q':
+                    slide(1, 1); slide(1, -1); slide(-1, 1); slide(-1, -1);
+                    slide(1, 0); slide(-1, 0); slide(0, 1); slide(0, -1);
+                    break;
+            }
+
+            for (int toY = 0; toY < 8; ++toY)
+                for (int toX = 0; toX < 8; ++toX) {
+                    if (!target[toY][toX]) continue;
+                    if (!(isTactical(fromX, fromY, toX, toY) ? tactical : quiet)) continue;
+                    std::string mv = std::string() + char('a' + fromX) + char('8' - fromY)
+                                     + char('a' + toX) + char('8' - toY);
+                    if (validateMove(mv).empty()) moves.push_back(mv);
+                }
+        }
+    }
+    return moves;
+}
+
 // Simulate move and check if it leaves current player in check
 bool Board::wouldLeaveKingInCheck(int fromX, int fromY, int toX, int toY) const {
     Board copy = *this;
@@ -382,7 +666,7 @@ bool Board::isStalemate(char player) const {
 bool Board::makeMove(const std::string &move) {
     std::string error = validateMove(move);
     if (!error.empty()) {
-        std::cout << "Invalid move: " << error << "\n";
+        LOG_DEBUG("Invalid move " << move << ": " << error);
         return false;
     }
 
@@ -392,6 +676,7 @@ bool Board::makeMove(const std::string &move) {
     int toY   = rankToY(move[3]);
 
     char moved = squares[fromY][fromX];
+    bool resetsClock = std::toupper(moved) == 'P' || squares[toY][toX] != '.';
 
     // Detect castling
     bool isCastling = false;
@@ -444,7 +729,7 @@ bool Board::makeMove(const std::string &move) {
     if (std::toupper(moved) == 'P') {
         if ((std::isupper(moved) && toY == 0) || (std::islower(moved) && toY == 7)) {
             squares[toY][toX] = std::isupper(moved) ? 'Q' : 'q';
-            std::cout << "Pawn promoted to Queen!\n";
+            LOG_DEBUG("Pawn promoted to Queen on " << move.substr(2));
         }
     }
 
@@ -471,6 +756,9 @@ bool Board::makeMove(const std::string &move) {
         enPassantY = -1;
     }
 
+    halfmoveClock = resetsClock ? 0 : halfmoveClock + 1;
+    if (currentPlayer == 'B') ++fullmoveNumber;
+
     lastMove = move;
     currentPlayer = (currentPlayer == 'W') ? 'B' : 'W';
     return true;
@@ -0,0 +1,213 @@
+#include "BotMCTS.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+BotMCTS::BotMCTS(int threads_, double moveTimeMs_, Playout playout_)
+    : threads(threads_ > 0 ? threads_ : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+      moveTimeMs(moveTimeMs_), playout(playout_) {}
+
+BotMCTS::~BotMCTS() = default;
+
+// Placement, side, castling and en passant: the move counters do not matter here
+std::string BotMCTS::positionKey(const Board &board) {
+    std::istringstream in(board.toFEN());
+    std::string placement, side, castling, ep;
+    in >> placement >> side >> castling >> ep;
+    return placement + " " + side + " " + castling + " " + ep;
+}
+
+double BotMCTS::materialBalance(const Board &board) {
+    double balance = 0.0;
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x) {
+            char p = board.getSquare(x, y);
+            double v = 0.0;
+            switch (std::toupper(static_cast<unsigned char>(p))) {
+                case 'P': v = 1.0; break;
+                case 'N': case 'B': v = 3.0; break;
+                case 'R': v = 5.0; break;
+                case 'Q': v = 9.0; break;
+            }
+            balance += std::isupper(static_cast<unsigned char>(p)) ? v : -v;
+        }
+    return balance;
+}
+
+std::string BotMCTS::getMove(Board &board, char botColor) {
+    if (board.getCurrentPlayer() != botColor) return "";
+    auto t0 = std::chrono::steady_clock::now();
+
+    reuseTree(board);
+    stats = Stats();
+    stats.reusedVisits = root->visits.load();
+    expand(root.get(), board);
+    if (root->children.empty()) return "";
+
+    // Every thread grows the same tree until the time or iteration budget runs out
+    std::atomic<uint64_t> iterations{ 0 };
+    auto deadline = t0 + std::chrono::duration<double, std::milli>(moveTimeMs);
+    auto work = [&](unsigned seed) {
+        std::mt19937 rng(seed);
+        while ((maxIterations == 0 || iterations < maxIterations) &&
+               (maxIterations > 0 || std::chrono::steady_clock::now() < deadline)) {
+            iterate(board, rng);
+            ++iterations;
+        }
+    };
+    std::random_device rd;
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(work, rd());
+    work(rd());
+    for (auto &t : pool) t.join();
+
+    // Play the most visited move and keep its subtree for next time
+    auto best = std::max_element(root->children.begin(), root->children.end(),
+                                 [](const auto &a, const auto &b) { return a->visits < b->visits; });
+    std::unique_ptr<Node> next = std::move(*best);
+    std::string move = next->move;
+
+    stats.iterations = iterations;
+    stats.rootVisits = root->visits;
+    stats.winRate = next->visits ? next->wins / next->visits : 0.0;
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    Board after = board;
+    after.makeMove(move);
+    next->parent = nullptr;
+    root = std::move(next);
+    rootFen = positionKey(after);
+    return move;
+}
+
+// Find the current position in the kept tree: the root itself, or one of its
+// children (the opponent's reply to the move we played). Otherwise start over.
+void BotMCTS::reuseTree(const Board &board) {
+    std::string key = positionKey(board);
+    if (root && rootFen == key) return;
+
+    std::unique_ptr<Node> found;
+    if (root && root->expanded) {
+        Board base;
+        base.loadFEN(rootFen);
+        for (auto &child : root->children) {
+            Board b = base;
+            if (b.makeMove(child->move) && positionKey(b) == key) {
+                found = std::move(child);
+                break;
+            }
+        }
+    }
+    if (found) found->parent = nullptr;
+    else found = std::make_unique<Node>();
+    root = std::move(found);
+    rootFen = key;
+}
+
+void BotMCTS::expand(Node *node, const Board &board) {
+    if (node->expanded.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(node->expandMutex);
+    if (node->expanded.load(std::memory_order_relaxed)) return;
+
+    std::vector<std::string> moves = board.legalMoves();
+    if (moves.empty()) {
+        // the side to move is mated (a win for whoever moved here) or stalemated
+        node->terminal = true;
+        node->terminalValue = board.isInCheck(board.getCurrentPlayer()) ? 1.0 : 0.5;
+    }
+    for (const std::string &mv : moves) {
+        auto child = std::make_unique<Node>();
+        child->move = mv;
+        child->parent = node;
+        node->children.push_back(std::move(child));
+    }
+    node->expanded.store(true, std::memory_order_release);
+}
+
+// UCT descent; each step adds a virtual loss (a visit without a win) that
+// the backup turns into a real result
+BotMCTS::Node *BotMCTS::select(Node *node, Board &board) {
+    while (node->expanded.load(std::memory_order_acquire) && !node->terminal) {
+        double logParent = std::log(std::max(1, node->visits.load()));
+        Node *best = nullptr;
+        double bestScore = -std::numeric_limits<double>::infinity();
+        for (auto &child : node->children) {
+            int n = child->visits.load(std::memory_order_relaxed);
+            double score = n == 0 ? std::numeric_limits<double>::infinity()
+                                  : child->wins.load(std::memory_order_relaxed) / n + EXPLORATION * std::sqrt(logParent / n);
+            if (score > bestScore) {
+                bestScore = score;
+                best = child.get();
+            }
+        }
+        best->visits.fetch_add(1, std::memory_order_relaxed);
+        board.makeMove(best->move);
+        node = best;
+    }
+    return node;
+}
+
+void BotMCTS::iterate(const Board &rootBoard, std::mt19937 &rng) {
+    Board board = rootBoard;
+    root->visits.fetch_add(1, std::memory_order_relaxed);
+    Node *leaf = select(root.get(), board);
+
+    // value for the side that made the move into the leaf
+    double value;
+    if (leaf->visits.load(std::memory_order_relaxed) > 1 || leaf == root.get()) expand(leaf, board);
+    if (leaf->terminal) {
+        value = leaf->terminalValue;
+    } else {
+        double whiteWins = simulate(board, rng);
+        value = board.getCurrentPlayer() == 'W' ? 1.0 - whiteWins : whiteWins;
+    }
+
+    for (Node *n = leaf; n; n = n->parent) {
+        n->wins.fetch_add(value, std::memory_order_relaxed);
+        value = 1.0 - value;
+    }
+}
+
+// Short playout, scored by material when it does not end on its own.
+// Returns White's expected result (1 win, 0.5 draw, 0 loss).
+double BotMCTS::simulate(Board board, std::mt19937 &rng) const {
+    auto victim = [&](const std::string &mv) {
+        char t = board.getSquare(mv[2] - 'a', '8' - mv[3]);
+        switch (std::toupper(static_cast<unsigned char>(t))) {
+            case 'P': return 1;
+            case 'N': case 'B': return 3;
+            case 'R': return 5;
+            case 'Q': return 9;
+        }
+        return 0;
+    };
+
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    for (int ply = 0; ply < PLAYOUT_PLIES; ++ply) {
+        std::vector<std::string> moves = board.legalMoves();
+        char side = board.getCurrentPlayer();
+        if (moves.empty()) {
+            if (!board.isInCheck(side)) return 0.5;
+            return side == 'W' ? 0.0 : 1.0;
+        }
+
+        const std::string *pick = &moves[rng() % moves.size()];
+        if (playout == Playout::Guided && coin(rng) < 0.8) {
+            // most valuable capture, if any
+            int bestVictim = 0;
+            for (const std::string &mv : moves) {
+                int v = victim(mv);
+                if (v > bestVictim) {
+                    bestVictim = v;
+                    pick = &mv;
+                }
+            }
+        }
+        board.makeMove(*pick);
+    }
+    return 1.0 / (1.0 + std::exp(-0.5 * materialBalance(board)));
+}
@@ -0,0 +1,30 @@
+#include "EvalCache.hpp"
+#include <algorithm>
+#include <bit>
+
+EvalCache::EvalCache(std::size_t entries)
+    : mask(std::bit_floor(std::max<std::size_t>(entries, 64)) - 1) {
+    slots = std::make_unique<Slot[]>(mask + 1);
+}
+
+bool EvalCache::probe(uint64_t key, double &whiteScore) const {
+    const Slot &s = slots[key & mask];
+    uint64_t data = s.data.load(std::memory_order_relaxed);
+    if ((s.keyXorData.load(std::memory_order_relaxed) ^ data) != key) return false;
+    whiteScore = std::bit_cast<double>(data);
+    return true;
+}
+
+void EvalCache::store(uint64_t key, double whiteScore) {
+    Slot &s = slots[key & mask];
+    uint64_t data = std::bit_cast<uint64_t>(whiteScore);
+    s.keyXorData.store(key ^ data, std::memory_order_relaxed);
+    s.data.store(data, std::memory_order_relaxed);
+}
+
+void EvalCache::clear() {
+    for (std::size_t i = 0; i <= mask; ++i) {
+        slots[i].keyXorData.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,31 @@
+#include "Log.hpp"
+#include <iostream>
+#include <mutex>
+
+namespace {
+std::mutex logMutex;
+std::function<void(int, const std::string &)> logSink;
+
+const char *levelName(int level) {
+    switch (level) {
+        case CHESSAI_LOG_LEVEL_ERROR: return "error";
+        case CHESSAI_LOG_LEVEL_WARN:  return "warn";
+        case CHESSAI_LOG_LEVEL_INFO:  return "info";
+        default:                      return "debug";
+    }
+}
+} // namespace
+
+void chesslog::write(int level, const std::string &message) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (logSink) {
+        logSink(level, message);
+        return;
+    }
+    std::cerr << "[" << levelName(level) << "] " << message << "\n";
+}
+
+void chesslog::setSink(std::function<void(int, const std::string &)> sink) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    logSink = std::move(sink);
+}
@@ -0,0 +1,178 @@
+#include "MateSolver.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+MateSolver::MateSolver(std::size_t ttEntries)
+    : table(std::bit_floor(std::max<std::size_t>(ttEntries, 1024))), mask(table.size() - 1) {}
+
+void MateSolver::clear() {
+    std::fill(table.begin(), table.end(), Entry());
+}
+
+// The Zobrist key (squares, side to move, castling, en passant), attacker and
+// the remaining depth: the same position with a different number of plies
+// left (or the other side mating) is a different question
+uint64_t MateSolver::positionKey(const Board &board, int pliesLeft) const {
+    uint64_t h = board.zobristKey();
+    h ^= static_cast<uint64_t>(attacker) << 8 | static_cast<uint64_t>(pliesLeft) << 16;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+bool MateSolver::lookup(uint64_t key, uint32_t &pn, uint32_t &dn) const {
+    const Entry &e = table[key & mask];
+    if (e.key != key) return false;
+    pn = e.pn;
+    dn = e.dn;
+    return true;
+}
+
+// Keep whichever entry cost more to compute
+void MateSolver::store(uint64_t key, uint32_t pn, uint32_t dn, uint32_t work) {
+    Entry &e = table[key & mask];
+    if (e.key != key && e.work > work) return;
+    e = { key, pn, dn, work };
+}
+
+MateSolver::Result MateSolver::solve(const Board &board, int maxMoves, uint64_t maxNodes, std::stop_token stop) {
+    auto t0 = std::chrono::steady_clock::now();
+    Result result;
+    attacker = board.getCurrentPlayer();
+    nodes = 0;
+    nodeLimit = maxNodes;
+    stopToken = stop;
+    aborted = false;
+
+    // mate in n = 2n-1 plies; shortest first
+    for (int n = 1; n <= maxMoves && !aborted; ++n) {
+        int plies = 2 * n - 1;
+        uint32_t pn, dn;
+        mid(board, plies, INF, INF, pn, dn);
+        if (!aborted && pn == 0) {
+            result.mate = true;
+            result.mateIn = n;
+            result.pv = provenLine(board, plies);
+            if (!result.pv.empty()) result.move = result.pv.front();
+            break;
+        }
+    }
+
+    result.nodes = nodes;
+    result.exhausted = aborted;
+    result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+// Multiple iterative deepening at one node: keep expanding the most proving
+// child until this node's numbers reach the thresholds passed down
+void MateSolver::mid(const Board &board, int pliesLeft, uint32_t thpn, uint32_t thdn, uint32_t &pn, uint32_t &dn) {
+    uint64_t key = positionKey(board, pliesLeft);
+    uint64_t startNodes = nodes++;
+    pn = dn = 1;
+    if (nodes > nodeLimit || stopToken.stop_requested()) {
+        aborted = true;
+        return;
+    }
+
+    bool orNode = board.getCurrentPlayer() == attacker;
+    std::vector<std::string> moves = board.legalMoves();
+    if (moves.empty()) {
+        // mate proves the attacker's line, stalemate or the attacker being mated refutes it
+        bool mated = !orNode && board.isInCheck(board.getCurrentPlayer());
+        pn = mated ? 0 : INF;
+        dn = mated ? INF : 0;
+        store(key, pn, dn, 1);
+        return;
+    }
+    if (pliesLeft == 0) {
+        pn = INF; // out of moves without mate
+        dn = 0;
+        store(key, pn, dn, 1);
+        return;
+    }
+
+    std::vector<Board> children(moves.size(), board);
+    std::vector<uint64_t> keys(moves.size());
+    // The children's numbers are kept here as well as in the table, so a
+    // result the table declines to store is not lost to this node
+    std::vector<uint32_t> childPns(moves.size(), 1), childDns(moves.size(), 1);
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        children[i].makeMove(moves[i]);
+        keys[i] = positionKey(children[i], pliesLeft - 1);
+        // checks are the likeliest road to mate: quiet attacker moves start harder to prove
+        if (orNode && !children[i].isInCheck(children[i].getCurrentPlayer())) childPns[i] = 3;
+        lookup(keys[i], childPns[i], childDns[i]);
+    }
+
+    for (;;) {
+        // combine the children: OR = attacker picks one, AND = every defence must fail
+        pn = orNode ? INF : 0;
+        dn = orNode ? 0 : INF;
+        uint32_t best1 = INF, best2 = INF; // smallest and second smallest pn (OR) or dn (AND)
+        std::size_t bestChild = 0;
+        uint32_t bestPn = 0, bestDn = 0;
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            uint32_t cpn = childPns[i], cdn = childDns[i];
+            uint32_t v = orNode ? cpn : cdn;
+            if (v < best1) {
+                best2 = best1;
+                best1 = v;
+                bestChild = i;
+                bestPn = cpn;
+                bestDn = cdn;
+            } else if (v < best2) {
+                best2 = v;
+            }
+            if (orNode) {
+                pn = std::min(pn, cpn);
+                dn = std::min(INF, dn + cdn);
+            } else {
+                pn = std::min(INF, pn + cpn);
+                dn = std::min(dn, cdn);
+            }
+        }
+
+        store(key, pn, dn, static_cast<uint32_t>(std::min<uint64_t>(nodes - startNodes, INF)));
+        if (pn >= thpn || dn >= thdn || aborted) return;
+
+        // thresholds for the chosen child
+        uint32_t childPn, childDn;
+        if (orNode) {
+            childPn = std::min(thpn, best2 == INF ? INF : best2 + 1);
+            childDn = std::min<uint64_t>(INF, static_cast<uint64_t>(thdn) - dn + bestDn);
+        } else {
+            childDn = std::min(thdn, best2 == INF ? INF : best2 + 1);
+            childPn = std::min<uint64_t>(INF, static_cast<uint64_t>(thpn) - pn + bestPn);
+        }
+        mid(children[bestChild], pliesLeft - 1, childPn, childDn, childPns[bestChild], childDns[bestChild]);
+    }
+}
+
+// Follow proven entries: the attacker plays a proven move, the defender the
+// reply that is still proven (any of them is, since all are refuted)
+std::vector<std::string> MateSolver::provenLine(const Board &board, int pliesLeft) const {
+    std::vector<std::string> line;
+    Board pos = board;
+    for (int ply = pliesLeft; ply > 0; --ply) {
+        std::vector<std::string> moves = pos.legalMoves();
+        std::string next;
+        for (const std::string &mv : moves) {
+            Board child = pos;
+            child.makeMove(mv);
+            uint32_t pn, dn;
+            if (child.legalMoves().empty() && child.isInCheck(child.getCurrentPlayer()) && pos.getCurrentPlayer() == attacker) {
+                next = mv; // mate on the board
+                break;
+            }
+            if (lookup(positionKey(child, ply - 1), pn, dn) && pn == 0 && next.empty()) next = mv;
+        }
+        if (next.empty()) break;
+        line.push_back(next);
+        pos.makeMove(next);
+        if (pos.legalMoves().empty()) break;
+    }
+    return line;
+}
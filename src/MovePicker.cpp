@@ -0,0 +1,125 @@
+#include "MovePicker.hpp"
+#include <algorithm>
+#include <cctype>
+
+MovePicker::MovePicker(const Board &board_, const std::string &ttMove_, const Killers &killers_,
+                       const History &history_)
+    : board(board_), ttMove(ttMove_), killers(killers_), history(history_) {}
+
+int MovePicker::value(char piece) {
+    switch (std::toupper(static_cast<unsigned char>(piece))) {
+        case 'P': return 1;
+        case 'N': case 'B': return 3;
+        case 'R': return 5;
+        case 'Q': return 9;
+        case 'K': return 100;
+    }
+    return 0;
+}
+
+bool MovePicker::isQuiet(const Board &board, const std::string &move) {
+    return !board.isTactical(move[0] - 'a', '8' - move[1], move[2] - 'a', '8' - move[3]);
+}
+
+// Without exchange evaluation: taking a smaller piece on a square the
+// opponent defends probably loses material
+bool MovePicker::losingCapture(const std::string &move) const {
+    char attacker = board.getSquare(move[0] - 'a', '8' - move[1]);
+    char victim = board.getSquare(move[2] - 'a', '8' - move[3]);
+    if (value(victim) >= value(attacker)) return false;
+    bool byWhite = board.getCurrentPlayer() == 'B';
+    return board.isSquareAttacked(move[2] - 'a', '8' - move[3], byWhite);
+}
+
+bool MovePicker::alreadyTried(const std::string &move) const {
+    if (move == ttMove) return true;
+    if (stage == Stage::Quiets) return move == killers[0] || move == killers[1];
+    return false;
+}
+
+bool MovePicker::next(std::string &move) {
+    for (;;) {
+        switch (stage) {
+            case Stage::TtMove:
+                stage = Stage::GenCaptures;
+                if (!ttMove.empty() && board.isMoveValid(ttMove)) {
+                    move = ttMove;
+                    return true;
+                }
+                ttMove.clear();
+                break;
+
+            case Stage::GenCaptures: {
+                moves = board.legalCaptures();
+                // most valuable victim, then least valuable attacker
+                auto score = [this](const std::string &mv) {
+                    return value(board.getSquare(mv[2] - 'a', '8' - mv[3])) * 16
+                         - value(board.getSquare(mv[0] - 'a', '8' - mv[1]));
+                };
+                std::stable_sort(moves.begin(), moves.end(),
+                                 [&](const std::string &a, const std::string &b) { return score(a) > score(b); });
+                index = 0;
+                stage = Stage::GoodCaptures;
+                break;
+            }
+
+            case Stage::GoodCaptures:
+                while (index < moves.size()) {
+                    const std::string &mv = moves[index++];
+                    if (alreadyTried(mv)) continue;
+                    if (losingCapture(mv)) {
+                        badCaptures.push_back(mv);
+                        continue;
+                    }
+                    move = mv;
+                    return true;
+                }
+                stage = Stage::Killers;
+                break;
+
+            case Stage::Killers:
+                while (killerIndex < killers.size()) {
+                    const std::string &mv = killers[killerIndex++];
+                    if (mv.empty() || mv == ttMove || !board.isMoveValid(mv) || !isQuiet(board, mv)) continue;
+                    move = mv;
+                    return true;
+                }
+                stage = Stage::GenQuiets;
+                break;
+
+            case Stage::GenQuiets: {
+                moves = board.legalQuiets();
+                auto score = [this](const std::string &mv) {
+                    return history[square(mv[0], mv[1])][square(mv[2], mv[3])];
+                };
+                std::stable_sort(moves.begin(), moves.end(),
+                                 [&](const std::string &a, const std::string &b) { return score(a) > score(b); });
+                index = 0;
+                stage = Stage::Quiets;
+                break;
+            }
+
+            case Stage::Quiets:
+                while (index < moves.size()) {
+                    const std::string &mv = moves[index++];
+                    if (alreadyTried(mv)) continue;
+                    move = mv;
+                    return true;
+                }
+                index = 0;
+                stage = Stage::BadCaptures;
+                break;
+
+            case Stage::BadCaptures:
+                if (index < badCaptures.size()) {
+                    move = badCaptures[index++];
+                    return true;
+                }
+                stage = Stage::Done;
+                break;
+
+            case Stage::Done:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,258 @@
+#include "PackedPosition.hpp"
+#include "Board.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+const char BLOCK_MAGIC[8] = { 'C', 'A', 'I', 'P', 'O', 'S', '0', '1' };
+const char PIECES[] = "PNBRQKpnbrqk";
+
+// The planes are mostly zero, so the run-length code is built around zeros:
+//   0x00-0x7f : c zeros, then one literal byte (none if the block ends there)
+//   0x80-0xbf : c-0x7f literal bytes (1..64)
+//   0xc0-0xff : (c-0xbf)*128 zeros (128..8192)
+void encodeRuns(const uint8_t *data, std::size_t size, std::string &out) {
+    std::size_t i = 0;
+    while (i < size) {
+        std::size_t zeros = 0;
+        while (i + zeros < size && data[i + zeros] == 0) ++zeros;
+        if (zeros >= 128) {
+            std::size_t chunks = std::min<std::size_t>(zeros / 128, 64);
+            out.push_back(static_cast<char>(0xbf + chunks));
+            i += chunks * 128;
+            continue;
+        }
+        if (zeros == 0) {
+            // a stretch of non-zero bytes goes out as one literal
+            std::size_t n = 0;
+            while (i + n < size && data[i + n] != 0 && n < 64) ++n;
+            if (n >= 2) {
+                out.push_back(static_cast<char>(0x7f + n));
+                out.append(reinterpret_cast<const char *>(data + i), n);
+                i += n;
+                continue;
+            }
+        }
+        out.push_back(static_cast<char>(zeros));
+        i += zeros;
+        if (i < size) out.push_back(static_cast<char>(data[i++]));
+    }
+}
+
+bool decodeRuns(const std::string &in, uint8_t *data, std::size_t size) {
+    std::size_t o = 0;
+    for (std::size_t i = 0; i < in.size();) {
+        uint8_t c = static_cast<uint8_t>(in[i++]);
+        std::size_t zeros = c < 0x80 ? c : c >= 0xc0 ? (c - 0xbfu) * 128 : 0;
+        if (o + zeros > size) return false;
+        std::memset(data + o, 0, zeros);
+        o += zeros;
+
+        std::size_t literal = c < 0x80 ? (o < size ? 1 : 0) : c < 0xc0 ? c - 0x7fu : 0;
+        if (o + literal > size || i + literal > in.size()) return false;
+        std::memcpy(data + o, in.data() + i, literal);
+        i += literal;
+        o += literal;
+    }
+    return o == size;
+}
+
+// The codec works on a wider form of each record: one nibble per square
+// instead of one per piece, so a move changes two bytes however the pieces
+// are ordered, and the score from White's view, which changes less between
+// plies than the side to move's.
+constexpr std::size_t WIDE = 40;
+
+void widen(const PackedPosition &p, uint8_t *w) {
+    std::memset(w, 0, 32);
+    int count = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (!(p.occupancy >> sq & 1)) continue;
+        uint8_t code = (count % 2) ? p.pieces[count / 2] >> 4 : p.pieces[count / 2] & 0xf;
+        ++count;
+        w[sq / 2] |= (sq % 2) ? code << 4 : code;
+    }
+    PackedPosition q = p;
+    if (q.flags & 1) q.score = static_cast<int16_t>(-q.score);
+    std::memcpy(w + 32, reinterpret_cast<const uint8_t *>(&q) + 24, 8);
+}
+
+// What the next ply of the same game looks like: the other side to move,
+// the clocks advanced
+void predictNext(const uint8_t *prev, uint8_t *next) {
+    std::memcpy(next, prev, WIDE);
+    next[32] ^= 1;                      // flags: side to move
+    next[37] = static_cast<uint8_t>(prev[37] + 1); // halfmove clock
+    uint16_t fullmove;
+    std::memcpy(&fullmove, prev + 38, 2);
+    fullmove = static_cast<uint16_t>(fullmove + (prev[32] & 1));
+    std::memcpy(next + 38, &fullmove, 2);
+}
+
+void narrow(const uint8_t *w, PackedPosition &p) {
+    std::memcpy(reinterpret_cast<uint8_t *>(&p) + 24, w + 32, 8);
+    if (p.flags & 1) p.score = static_cast<int16_t>(-p.score);
+    p.occupancy = 0;
+    std::memset(p.pieces, 0, sizeof(p.pieces));
+    int count = 0;
+    for (int sq = 0; sq < 64 && count < 32; ++sq) {
+        uint8_t code = (sq % 2) ? w[sq / 2] >> 4 : w[sq / 2] & 0xf;
+        if (!code) continue;
+        p.occupancy |= uint64_t(1) << sq;
+        p.pieces[count / 2] |= (count % 2) ? code << 4 : code;
+        ++count;
+    }
+}
+
+} // namespace
+
+// Packs through the FEN, which already knows which castling rights are usable
+PackedPosition PackedPosition::pack(const Board &board, double score, int result) {
+    PackedPosition p;
+    std::istringstream in(board.toFEN());
+    std::string placement, side, castling, ep;
+    int halfmove = 0, fullmove = 1;
+    in >> placement >> side >> castling >> ep >> halfmove >> fullmove;
+
+    int count = 0;
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x) {
+            char c = board.getSquare(x, y);
+            if (c == '.' || count == 32) continue;
+            p.occupancy |= uint64_t(1) << (y * 8 + x);
+            uint8_t code = static_cast<uint8_t>(std::strchr(PIECES, c) - PIECES + 1);
+            p.pieces[count / 2] |= (count % 2) ? code << 4 : code;
+            ++count;
+        }
+
+    if (side == "b") p.flags |= 1;
+    const char *rights = "KQkq";
+    for (char c : castling)
+        if (const char *r = std::strchr(rights, c)) p.flags |= 2 << (r - rights);
+    if (ep != "-") p.epFile = static_cast<uint8_t>(ep[0] - 'a');
+    p.score = static_cast<int16_t>(std::clamp(std::lround(score * 100.0), -32000L, 32000L));
+    p.result = static_cast<int8_t>(result);
+    p.halfmoveClock = static_cast<uint8_t>(std::min(halfmove, 255));
+    p.fullmoveNumber = static_cast<uint16_t>(std::clamp(fullmove, 1, 65535));
+    return p;
+}
+
+std::string PackedPosition::toFEN() const {
+    std::string fen;
+    int count = 0;
+    for (int y = 0; y < 8; ++y) {
+        int empty = 0;
+        for (int x = 0; x < 8; ++x) {
+            if (!(occupancy >> (y * 8 + x) & 1)) { ++empty; continue; }
+            if (empty) fen += char('0' + empty);
+            empty = 0;
+            int code = (count % 2) ? pieces[count / 2] >> 4 : pieces[count / 2] & 0xf;
+            fen += (code >= 1 && code <= 12) ? PIECES[code - 1] : '?';
+            ++count;
+        }
+        if (empty) fen += char('0' + empty);
+        if (y < 7) fen += '/';
+    }
+
+    fen += (flags & 1) ? " b " : " w ";
+    std::string castling;
+    for (int i = 0; i < 4; ++i)
+        if (flags & (2 << i)) castling += "KQkq"[i];
+    fen += castling.empty() ? "-" : castling;
+
+    fen += ' ';
+    if (epFile > 7) fen += '-';
+    else { fen += char('a' + epFile); fen += (flags & 1) ? '3' : '6'; }
+
+    fen += ' ' + std::to_string(halfmoveClock) + ' ' + std::to_string(fullmoveNumber);
+    return fen;
+}
+
+bool PackedWriter::open(const std::string &path) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR("Cannot write " << path);
+        return false;
+    }
+    block.reserve(BLOCK_POSITIONS);
+    return true;
+}
+
+void PackedWriter::write(const PackedPosition &pos) {
+    block.push_back(pos);
+    ++written;
+    if (block.size() == BLOCK_POSITIONS) flush();
+}
+
+void PackedWriter::flush() {
+    if (block.empty() || !out) return;
+    // Subtract from every (widened) record the prediction made from the one
+    // before it, then store byte planes (byte 0 of every record, then byte
+    // 1, ...) so unchanged squares and fields become zero runs
+    const std::size_t n = block.size();
+    std::vector<uint8_t> wide(n * WIDE), planes(n * WIDE);
+    uint8_t predicted[WIDE] = {};
+    for (std::size_t k = 0; k < n; ++k) {
+        widen(block[k], &wide[k * WIDE]);
+        if (k) predictNext(&wide[(k - 1) * WIDE], predicted);
+        for (std::size_t i = 0; i < WIDE; ++i)
+            planes[i * n + k] = static_cast<uint8_t>(wide[k * WIDE + i] - predicted[i]);
+    }
+    std::string payload;
+    encodeRuns(planes.data(), planes.size(), payload);
+
+    uint32_t header[2] = { static_cast<uint32_t>(n), static_cast<uint32_t>(payload.size()) };
+    out.write(BLOCK_MAGIC, 8);
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    bytesOut += 8 + sizeof(header) + payload.size();
+    block.clear();
+}
+
+bool PackedWriter::close() {
+    if (!out.is_open()) return true;
+    flush();
+    out.close();
+    return !out.fail();
+}
+
+bool PackedReader::open(const std::string &path) {
+    in.open(path, std::ios::binary);
+    if (!in) {
+        LOG_ERROR("Cannot read " << path);
+        return false;
+    }
+    return true;
+}
+
+bool PackedReader::readBlock(std::vector<PackedPosition> &positions) {
+    char magic[8];
+    uint32_t header[2];
+    if (!in.read(magic, 8) || !in.read(reinterpret_cast<char *>(header), sizeof(header))) return false;
+    if (std::memcmp(magic, BLOCK_MAGIC, 8) != 0 || header[0] > PackedWriter::BLOCK_POSITIONS) {
+        LOG_ERROR("Bad packed position block");
+        return false;
+    }
+    std::string payload(header[1], '\0');
+    if (!in.read(payload.data(), header[1])) return false;
+
+    const std::size_t n = header[0];
+    std::vector<uint8_t> wide(n * WIDE), planes(n * WIDE);
+    if (!decodeRuns(payload, planes.data(), planes.size())) {
+        LOG_ERROR("Corrupt packed position block");
+        return false;
+    }
+    positions.resize(n);
+    uint8_t predicted[WIDE] = {};
+    for (std::size_t k = 0; k < n; ++k) {
+        if (k) predictNext(&wide[(k - 1) * WIDE], predicted);
+        for (std::size_t i = 0; i < WIDE; ++i)
+            wide[k * WIDE + i] = static_cast<uint8_t>(planes[i * n + k] + predicted[i]);
+        narrow(&wide[k * WIDE], positions[k]);
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "PawnStructure.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+constexpr double DOUBLED = 0.2;     // per extra pawn on a file
+constexpr double ISOLATED = 0.15;
+constexpr double BACKWARD = 0.1;
+// by ranks advanced from the pawn's starting rank
+constexpr double PASSED[6] = { 0.05, 0.1, 0.15, 0.3, 0.5, 0.8 };
+
+bool pawnAt(const Board &board, int x, int y, char pawn) {
+    return x >= 0 && x < 8 && y >= 0 && y < 8 && board.getSquare(x, y) == pawn;
+}
+
+// Score of one side's pawns; dir is the y step forward (-1 White, +1 Black)
+double sideScore(const Board &board, char pawn, char enemy, int dir) {
+    double score = 0.0;
+    for (int x = 0; x < 8; ++x) {
+        int onFile = 0;
+        for (int y = 0; y < 8; ++y) {
+            if (board.getSquare(x, y) != pawn) continue;
+            ++onFile;
+
+            bool isolated = true, supportable = false, passed = true;
+            for (int f = std::max(0, x - 1); f <= std::min(7, x + 1); ++f)
+                for (int py = 0; py < 8; ++py) {
+                    char p = board.getSquare(f, py);
+                    bool ahead = (py - y) * dir > 0;
+                    if (p == enemy && ahead) passed = false;
+                    if (p == pawn && f != x) {
+                        isolated = false;
+                        if (!ahead) supportable = true; // level or behind: can defend the advance
+                    }
+                }
+
+            int advanced = dir < 0 ? 6 - y : y - 1;
+            if (passed) score += PASSED[std::clamp(advanced, 0, 5)];
+            if (isolated) {
+                score -= ISOLATED;
+            } else if (!supportable && !passed) {
+                // the square in front is held by an enemy pawn and no friend can cover it
+                int stop = y + dir;
+                if (pawnAt(board, x - 1, stop + dir, enemy) || pawnAt(board, x + 1, stop + dir, enemy))
+                    score -= BACKWARD;
+            }
+        }
+        if (onFile > 1) score -= DOUBLED * (onFile - 1);
+    }
+    return score;
+}
+
+} // namespace
+
+double pawnStructureScore(const Board &board) {
+    return sideScore(board, 'P', 'p', -1) - sideScore(board, 'p', 'P', 1);
+}
+
+PawnHash::PawnHash(std::size_t entries)
+    : table(std::bit_floor(std::max<std::size_t>(entries, 64))), mask(table.size() - 1) {}
+
+double PawnHash::probe(const Board &board) {
+    uint64_t key = board.pawnKey();
+    Entry &e = table[key & mask];
+    ++probes;
+    if (e.key == key) {
+        ++hits;
+        return e.score;
+    }
+    e = { key, pawnStructureScore(board) };
+    return e.score;
+}
+
+void PawnHash::clear() {
+    std::fill(table.begin(), table.end(), Entry());
+}
@@ -0,0 +1,221 @@
+#include "SharedTranspositionTable.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t HUGE_PAGE = 2u << 20;
+
+std::string segmentName(const std::string &name) {
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+// mmap gives no alignment beyond a normal page, so reserve a huge page more
+// address space than needed, map the segment at the first huge-page boundary
+// in it and give the rest back
+void *mapAligned(int fd, std::size_t bytes) {
+    const std::size_t reserved = bytes + HUGE_PAGE;
+    void *area = mmap(nullptr, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (area == MAP_FAILED) return MAP_FAILED;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(area);
+    const uintptr_t aligned = (start + HUGE_PAGE - 1) & ~uintptr_t(HUGE_PAGE - 1);
+
+    void *p = mmap(reinterpret_cast<void *>(aligned), bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (p == MAP_FAILED) {
+        int err = errno;
+        munmap(area, reserved);
+        errno = err;
+        return MAP_FAILED;
+    }
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t end = aligned + ((bytes + page - 1) & ~(page - 1));
+    if (aligned > start) munmap(area, aligned - start);
+    if (start + reserved > end) munmap(reinterpret_cast<void *>(end), start + reserved - end);
+    return p;
+}
+
+} // namespace
+
+SharedTranspositionTable::~SharedTranspositionTable() {
+    if (mapping) munmap(mapping, mappingBytes);
+}
+
+bool SharedTranspositionTable::attach(const std::string &name, std::size_t sizeMb, bool hugePages) {
+    static_assert(sizeof(Bucket) == 32 && std::atomic<uint64_t>::is_always_lock_free,
+                  "shared entries must be plain lock-free words");
+    if (mapping) return false;
+    std::string seg = segmentName(name);
+
+    // Power-of-two bucket count, so the index is a mask
+    uint64_t wanted = std::max<uint64_t>(1, (sizeMb << 20) / sizeof(Bucket));
+    uint64_t count = std::bit_floor(wanted);
+
+    bool creator = true;
+    int fd = shm_open(seg.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        creator = false;
+        fd = shm_open(seg.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        LOG_ERROR("shm_open " << seg << ": " << std::strerror(errno));
+        return false;
+    }
+
+    // The header is padded to a whole huge page and the mapping starts on one,
+    // so the buckets start on a 2 MB boundary too
+    std::size_t bytes = HUGE_PAGE + count * sizeof(Bucket);
+    if (creator) {
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            LOG_ERROR("ftruncate " << seg << ": " << std::strerror(errno));
+            close(fd);
+            shm_unlink(seg.c_str());
+            return false;
+        }
+    } else {
+        // the creator may still be sizing the segment
+        struct stat st{};
+        for (int i = 0; i < 100 && fstat(fd, &st) == 0 && st.st_size == 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (static_cast<std::size_t>(st.st_size) <= HUGE_PAGE) {
+            LOG_ERROR("shared table " << seg << " is not initialised");
+            close(fd);
+            return false;
+        }
+        bytes = static_cast<std::size_t>(st.st_size);
+    }
+
+    void *p = mapAligned(fd, bytes);
+    close(fd);
+    if (p == MAP_FAILED) {
+        LOG_ERROR("mmap " << seg << ": " << std::strerror(errno));
+        return false;
+    }
+    if (hugePages && madvise(p, bytes, MADV_HUGEPAGE) != 0)
+        LOG_WARN("huge pages unavailable for " << seg << ": " << std::strerror(errno));
+
+    // A fresh segment is zero-filled, i.e. already an empty table
+    auto *header = static_cast<Header *>(p);
+    if (creator) {
+        header->bucketCount = count;
+        header->magic.store(MAGIC, std::memory_order_release);
+    } else {
+        for (int i = 0; i < 100 && header->magic.load(std::memory_order_acquire) != MAGIC; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (header->magic.load(std::memory_order_acquire) != MAGIC ||
+            HUGE_PAGE + header->bucketCount * sizeof(Bucket) > bytes) {
+            LOG_ERROR("shared table " << seg << " has an unexpected layout");
+            munmap(p, bytes);
+            return false;
+        }
+        count = header->bucketCount;
+    }
+
+    mapping = p;
+    mappingBytes = bytes;
+    buckets = reinterpret_cast<Bucket *>(static_cast<char *>(p) + HUGE_PAGE);
+    bucketMask = count - 1;
+    LOG_INFO("shared table " << seg << (creator ? " created, " : " attached, ") << count << " buckets");
+    return true;
+}
+
+bool SharedTranspositionTable::remove(const std::string &name) {
+    return shm_unlink(segmentName(name).c_str()) == 0;
+}
+
+// FNV-1a over the board key, finished with a 64-bit mix
+uint64_t SharedTranspositionTable::hashKey(const std::string &key) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// data word: value (float bits) | depth << 32 | from << 40 | to << 46 | hasMove << 52 | used << 53
+// | bound << 54 (the used bit keeps every stored word non-zero, zero means an empty slot)
+uint64_t SharedTranspositionTable::pack(const Entry &entry) {
+    uint64_t d = std::bit_cast<uint32_t>(static_cast<float>(entry.value));
+    d |= static_cast<uint64_t>(std::clamp(entry.depth, 0, 255)) << 32 | (1ULL << 53);
+    d |= static_cast<uint64_t>(entry.bound & 3) << 54;
+    if (entry.bestMove.size() >= 4) {
+        const std::string &m = entry.bestMove;
+        uint64_t from = static_cast<uint64_t>(('8' - m[1]) * 8 + (m[0] - 'a'));
+        uint64_t to = static_cast<uint64_t>(('8' - m[3]) * 8 + (m[2] - 'a'));
+        d |= (from << 40) | (to << 46) | (1ULL << 52);
+    }
+    return d;
+}
+
+void SharedTranspositionTable::unpack(uint64_t d, Entry &out) {
+    out.value = std::bit_cast<float>(static_cast<uint32_t>(d));
+    out.depth = static_cast<int>((d >> 32) & 0xff);
+    out.bound = static_cast<Bound>((d >> 54) & 3);
+    out.bestMove.clear();
+    if (d & (1ULL << 52)) {
+        int from = static_cast<int>((d >> 40) & 63), to = static_cast<int>((d >> 46) & 63);
+        out.bestMove = { char('a' + from % 8), char('8' - from / 8), char('a' + to % 8), char('8' - to / 8) };
+    }
+}
+
+bool SharedTranspositionTable::probe(const std::string &key, Entry &out) const {
+    if (!buckets) return false;
+    uint64_t h = hashKey(key);
+    const Bucket &b = buckets[h & bucketMask];
+    for (const Slot &s : b.slots) {
+        uint64_t data = s.data.load(std::memory_order_relaxed);
+        if ((s.keyXorData.load(std::memory_order_relaxed) ^ data) == h && data != 0) {
+            unpack(data, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SharedTranspositionTable::store(const std::string &key, const Entry &entry) {
+    if (!buckets) return;
+    uint64_t h = hashKey(key);
+    uint64_t data = pack(entry);
+    Bucket &b = buckets[h & bucketMask];
+
+    // Same position or a shallower result: take the depth-preferred slot,
+    // otherwise fall back to the always-replace slot
+    Slot &deep = b.slots[0];
+    uint64_t oldData = deep.data.load(std::memory_order_relaxed);
+    bool sameKey = (deep.keyXorData.load(std::memory_order_relaxed) ^ oldData) == h;
+    int oldDepth = static_cast<int>((oldData >> 32) & 0xff);
+    Slot &s = (oldData == 0 || sameKey || entry.depth >= oldDepth) ? deep : b.slots[1];
+
+    s.keyXorData.store(h ^ data, std::memory_order_relaxed);
+    s.data.store(data, std::memory_order_relaxed);
+}
+
+void SharedTranspositionTable::clear() {
+    if (!buckets) return;
+    for (uint64_t i = 0; i <= bucketMask; ++i)
+        for (Slot &s : buckets[i].slots) {
+            s.data.store(0, std::memory_order_relaxed);
+            s.keyXorData.store(0, std::memory_order_relaxed);
+        }
+}
+
+std::size_t SharedTranspositionTable::size() const {
+    if (!buckets) return 0;
+    uint64_t sample = std::min<uint64_t>(bucketMask + 1, 4096), used = 0;
+    for (uint64_t i = 0; i < sample; ++i)
+        for (const Slot &s : buckets[i].slots) used += s.data.load(std::memory_order_relaxed) != 0;
+    return static_cast<std::size_t>(used * ((bucketMask + 1) / sample));
+}
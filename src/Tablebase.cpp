@@ -0,0 +1,686 @@
+#include "Tablebase.hpp"
+#include "Board.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Piece types in canonical order (strongest first after the king)
+enum PieceType { KING = 0, QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
+const char TYPE_CHARS[] = "KQRBNP";
+
+// Entry codes. The first four are what .wdl files store (2 bits each);
+// UNKNOWN only exists while a table is being generated.
+enum : uint8_t { WDL_DRAW = 0, WDL_WIN = 1, WDL_LOSS = 2, WDL_INVALID = 3, WDL_UNKNOWN = 4 };
+
+const char WDL_MAGIC[8] = { 'C', 'A', 'I', 'T', 'B', 'W', 'D', 'L' };
+const char DTZ_MAGIC[8] = { 'C', 'A', 'I', 'T', 'B', 'D', 'T', 'Z' };
+const std::size_t HEADER_SIZE = 16; // magic + uint32 piece count + uint32 reserved
+const uint8_t DTZ_NONE = 255;
+const uint8_t DTZ_MAX = 254;
+
+// Compact position used by the generator and the prober.
+// sq = y*8 + x with the same mapping as Board (y = 0 is rank 8).
+struct TbPiece {
+    int type;
+    bool white;
+    int sq;
+};
+
+struct TbPos {
+    int n = 0;
+    TbPiece p[4];
+    bool whiteToMove = true;
+};
+
+int typeFromChar(char c) {
+    const char *at = std::strchr(TYPE_CHARS, std::toupper(static_cast<unsigned char>(c)));
+    return at ? static_cast<int>(at - TYPE_CHARS) : -1;
+}
+
+uint64_t tableSize(int pieces) { return 2ull << (6 * pieces); }
+
+// Side-to-move is the most significant digit, then one base-64 digit per piece
+uint64_t encode(const TbPos &pos) {
+    uint64_t idx = pos.whiteToMove ? 0 : 1;
+    for (int i = 0; i < pos.n; ++i) idx = (idx << 6) | static_cast<uint64_t>(pos.p[i].sq);
+    return idx;
+}
+
+void decode(uint64_t idx, const TbPos &layout, TbPos &pos) {
+    pos = layout;
+    for (int i = pos.n - 1; i >= 0; --i) {
+        pos.p[i].sq = static_cast<int>(idx & 63);
+        idx >>= 6;
+    }
+    pos.whiteToMove = (idx == 0);
+}
+
+// "KRvKN" -> pieces in canonical order with squares left at 0
+bool parseMaterial(const std::string &name, TbPos &pos) {
+    pos = TbPos();
+    bool white = true;
+    for (char c : name) {
+        if (c == 'v') { white = false; continue; }
+        int t = typeFromChar(c);
+        if (t < 0 || pos.n == 4) return false;
+        pos.p[pos.n++] = { t, white, 0 };
+    }
+    return pos.n >= 2;
+}
+
+std::string sideString(const TbPos &pos, bool white) {
+    std::string s;
+    for (int i = 0; i < pos.n; ++i)
+        if (pos.p[i].white == white) s.push_back(TYPE_CHARS[pos.p[i].type]);
+    std::sort(s.begin(), s.end(), [](char a, char b) { return typeFromChar(a) < typeFromChar(b); });
+    return s;
+}
+
+// true if side a ("KQ") is stronger than side b ("KR"); decides table orientation
+bool strongerSide(const std::string &a, const std::string &b) {
+    auto value = [](const std::string &s) {
+        int v = 0;
+        for (char c : s) {
+            switch (c) {
+                case 'Q': v += 9; break;
+                case 'R': v += 5; break;
+                case 'B': case 'N': v += 3; break;
+                case 'P': v += 1; break;
+            }
+        }
+        return v;
+    };
+    if (value(a) != value(b)) return value(a) > value(b);
+    if (a.size() != b.size()) return a.size() > b.size();
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (a[i] != b[i]) return typeFromChar(a[i]) < typeFromChar(b[i]);
+    return false;
+}
+
+// Swap colours and mirror ranks, which leaves the game value unchanged
+void flipColours(TbPos &pos) {
+    for (int i = 0; i < pos.n; ++i) {
+        pos.p[i].white = !pos.p[i].white;
+        pos.p[i].sq = (7 - pos.p[i].sq / 8) * 8 + pos.p[i].sq % 8;
+    }
+    pos.whiteToMove = !pos.whiteToMove;
+}
+
+// Orient so the stronger side is white, sort pieces, and return the table name
+std::string canonicalize(TbPos &pos) {
+    std::string w = sideString(pos, true), b = sideString(pos, false);
+    if (strongerSide(b, w)) {
+        flipColours(pos);
+        std::swap(w, b);
+    }
+    std::stable_sort(pos.p, pos.p + pos.n, [](const TbPiece &a, const TbPiece &c) {
+        if (a.white != c.white) return a.white;
+        return a.type < c.type;
+    });
+    return w + "v" + b;
+}
+
+int pieceAt(const TbPos &pos, int sq) {
+    for (int i = 0; i < pos.n; ++i)
+        if (pos.p[i].sq == sq) return i;
+    return -1;
+}
+
+int kingSquare(const TbPos &pos, bool white) {
+    for (int i = 0; i < pos.n; ++i)
+        if (pos.p[i].type == KING && pos.p[i].white == white) return pos.p[i].sq;
+    return -1;
+}
+
+bool slideClear(const TbPos &pos, int from, int to) {
+    int fx = from % 8, fy = from / 8, tx = to % 8, ty = to / 8;
+    int dx = (tx > fx) - (tx < fx), dy = (ty > fy) - (ty < fy);
+    for (int x = fx + dx, y = fy + dy; x != tx || y != ty; x += dx, y += dy)
+        if (pieceAt(pos, y * 8 + x) >= 0) return false;
+    return true;
+}
+
+bool isAttacked(const TbPos &pos, int sq, bool byWhite) {
+    int x = sq % 8, y = sq / 8;
+    for (int i = 0; i < pos.n; ++i) {
+        const TbPiece &pc = pos.p[i];
+        if (pc.white != byWhite || pc.sq == sq) continue;
+        int dx = x - pc.sq % 8, dy = y - pc.sq / 8;
+        int ax = std::abs(dx), ay = std::abs(dy);
+        switch (pc.type) {
+            case KING:   if (std::max(ax, ay) == 1) return true; break;
+            case KNIGHT: if ((ax == 1 && ay == 2) || (ax == 2 && ay == 1)) return true; break;
+            case PAWN:   if (ax == 1 && dy == (pc.white ? -1 : 1)) return true; break;
+            case ROOK:   if ((dx == 0 || dy == 0) && slideClear(pos, pc.sq, sq)) return true; break;
+            case BISHOP: if (ax == ay && slideClear(pos, pc.sq, sq)) return true; break;
+            case QUEEN:
+                if ((dx == 0 || dy == 0 || ax == ay) && slideClear(pos, pc.sq, sq)) return true;
+                break;
+        }
+    }
+    return false;
+}
+
+// Legal as a table entry: no overlaps, no pawns on the back ranks and the
+// side that just moved is not in check.
+bool isValid(const TbPos &pos) {
+    for (int i = 0; i < pos.n; ++i) {
+        if (pos.p[i].type == PAWN && (pos.p[i].sq < 8 || pos.p[i].sq >= 56)) return false;
+        for (int j = i + 1; j < pos.n; ++j)
+            if (pos.p[i].sq == pos.p[j].sq) return false;
+    }
+    return !isAttacked(pos, kingSquare(pos, !pos.whiteToMove), pos.whiteToMove);
+}
+
+const int KING_DIRS[8][2]   = { {1,0}, {-1,0}, {0,1}, {0,-1}, {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+const int KNIGHT_DIRS[8][2] = { {1,2}, {2,1}, {2,-1}, {1,-2}, {-1,-2}, {-2,-1}, {-2,1}, {-1,2} };
+
+// Calls fn(target, pawnMove) for every empty square piece i can step to.
+// Piece moves are reversible; with reverse set, pawns step backwards so the
+// same helper serves retrograde generation.
+template <class Fn>
+void forEachQuietTarget(const TbPos &pos, int i, bool reverse, Fn &&fn) {
+    const TbPiece &pc = pos.p[i];
+    int x = pc.sq % 8, y = pc.sq / 8;
+    auto empty = [&](int tx, int ty) {
+        return tx >= 0 && tx < 8 && ty >= 0 && ty < 8 && pieceAt(pos, ty * 8 + tx) < 0;
+    };
+
+    switch (pc.type) {
+        case PAWN: {
+            int dir = (pc.white ? -1 : 1) * (reverse ? -1 : 1);
+            int startRow = pc.white ? 6 : 1;
+            int doubleRow = pc.white ? 4 : 3;
+            if (!empty(x, y + dir)) break;
+            fn((y + dir) * 8 + x, true);
+            if (!reverse && y == startRow && empty(x, y + 2 * dir)) fn((y + 2 * dir) * 8 + x, true);
+            if (reverse && y == doubleRow && empty(x, y + 2 * dir)) fn((y + 2 * dir) * 8 + x, true);
+            break;
+        }
+        case KING:
+        case KNIGHT: {
+            const int (*dirs)[2] = (pc.type == KING) ? KING_DIRS : KNIGHT_DIRS;
+            for (int d = 0; d < 8; ++d)
+                if (empty(x + dirs[d][0], y + dirs[d][1]))
+                    fn((y + dirs[d][1]) * 8 + x + dirs[d][0], false);
+            break;
+        }
+        default: {
+            int from = (pc.type == BISHOP) ? 4 : 0;
+            int to = (pc.type == ROOK) ? 4 : 8;
+            for (int d = from; d < to; ++d)
+                for (int tx = x + KING_DIRS[d][0], ty = y + KING_DIRS[d][1]; empty(tx, ty);
+                     tx += KING_DIRS[d][0], ty += KING_DIRS[d][1])
+                    fn(ty * 8 + tx, false);
+            break;
+        }
+    }
+}
+
+// Calls fn(child, zeroing, conversion) for every legal move. conversion means
+// the child belongs to another table (capture or promotion).
+template <class Fn>
+void forEachMove(const TbPos &pos, Fn &&fn) {
+    bool us = pos.whiteToMove;
+    auto emit = [&](int i, int to, int victim, bool pawnMove) {
+        TbPos child = pos;
+        child.whiteToMove = !us;
+        child.p[i].sq = to;
+        bool conversion = victim >= 0;
+        if (pawnMove && (to < 8 || to >= 56)) {
+            child.p[i].type = QUEEN; // the engine always promotes to a queen
+            conversion = true;
+        }
+        if (victim >= 0) {
+            for (int j = victim; j + 1 < child.n; ++j) child.p[j] = child.p[j + 1];
+            --child.n;
+        }
+        if (isAttacked(child, kingSquare(child, us), !us)) return;
+        fn(child, pawnMove || victim >= 0, conversion);
+    };
+
+    for (int i = 0; i < pos.n; ++i) {
+        const TbPiece &pc = pos.p[i];
+        if (pc.white != us) continue;
+
+        forEachQuietTarget(pos, i, false, [&](int to, bool pawnMove) { emit(i, to, -1, pawnMove); });
+
+        // Captures
+        int x = pc.sq % 8, y = pc.sq / 8;
+        auto capture = [&](int tx, int ty, bool pawnMove) {
+            if (tx < 0 || tx > 7 || ty < 0 || ty > 7) return;
+            int victim = pieceAt(pos, ty * 8 + tx);
+            if (victim < 0 || pos.p[victim].white == us || pos.p[victim].type == KING) return;
+            emit(i, ty * 8 + tx, victim, pawnMove);
+        };
+        switch (pc.type) {
+            case PAWN: {
+                int dir = us ? -1 : 1;
+                capture(x - 1, y + dir, true);
+                capture(x + 1, y + dir, true);
+                break;
+            }
+            case KING:
+            case KNIGHT: {
+                const int (*dirs)[2] = (pc.type == KING) ? KING_DIRS : KNIGHT_DIRS;
+                for (int d = 0; d < 8; ++d) capture(x + dirs[d][0], y + dirs[d][1], false);
+                break;
+            }
+            default: {
+                int from = (pc.type == BISHOP) ? 4 : 0;
+                int to = (pc.type == ROOK) ? 4 : 8;
+                for (int d = from; d < to; ++d) {
+                    int tx = x + KING_DIRS[d][0], ty = y + KING_DIRS[d][1];
+                    while (tx >= 0 && tx < 8 && ty >= 0 && ty < 8 && pieceAt(pos, ty * 8 + tx) < 0) {
+                        tx += KING_DIRS[d][0];
+                        ty += KING_DIRS[d][1];
+                    }
+                    capture(tx, ty, false);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Calls fn(parent, zeroing) for every position in the same table that reaches
+// pos with one quiet (non-capturing, non-promoting) move.
+template <class Fn>
+void forEachUnmove(const TbPos &pos, Fn &&fn) {
+    bool mover = !pos.whiteToMove;
+    for (int i = 0; i < pos.n; ++i) {
+        if (pos.p[i].white != mover) continue;
+        forEachQuietTarget(pos, i, true, [&](int from, bool pawnMove) {
+            TbPos parent = pos;
+            parent.p[i].sq = from;
+            parent.whiteToMove = mover;
+            if (isValid(parent)) fn(parent, pawnMove);
+        });
+    }
+}
+
+uint8_t readWdl(const uint8_t *packed, uint64_t idx) {
+    return (packed[idx >> 2] >> ((idx & 3) * 2)) & 3;
+}
+
+void *mapFile(const std::string &path, std::size_t expected, const char magic[8]) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    void *map = nullptr;
+    if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) == expected) {
+        map = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) map = nullptr;
+    }
+    close(fd);
+    if (map && std::memcmp(map, magic, 8) != 0) {
+        munmap(map, expected);
+        map = nullptr;
+    }
+    return map;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Loading / probing
+
+Tablebase::~Tablebase() {
+    for (auto &kv : tables) {
+        if (kv.second.wdlMap) munmap(kv.second.wdlMap, kv.second.wdlMapSize);
+        if (kv.second.dtzMap) munmap(kv.second.dtzMap, kv.second.dtzMapSize);
+    }
+}
+
+bool Tablebase::loadTable(const std::string &dir, const std::string &name) {
+    TbPos layout;
+    if (!parseMaterial(name, layout)) return false;
+    uint64_t entries = tableSize(layout.n);
+
+    Table t;
+    t.pieces = layout.n;
+    t.wdlMapSize = HEADER_SIZE + entries / 4;
+    t.dtzMapSize = HEADER_SIZE + entries;
+    t.wdlMap = mapFile(dir + "/" + name + ".wdl", t.wdlMapSize, WDL_MAGIC);
+    t.dtzMap = mapFile(dir + "/" + name + ".dtz", t.dtzMapSize, DTZ_MAGIC);
+    if (!t.wdlMap || !t.dtzMap) {
+        if (t.wdlMap) munmap(t.wdlMap, t.wdlMapSize);
+        if (t.dtzMap) munmap(t.dtzMap, t.dtzMapSize);
+        return false;
+    }
+    t.wdl = static_cast<const uint8_t *>(t.wdlMap) + HEADER_SIZE;
+    t.dtz = static_cast<const uint8_t *>(t.dtzMap) + HEADER_SIZE;
+
+    auto old = tables.find(name);
+    if (old != tables.end()) {
+        munmap(old->second.wdlMap, old->second.wdlMapSize);
+        munmap(old->second.dtzMap, old->second.dtzMapSize);
+    }
+    tables[name] = t;
+    maxLoadedPieces = std::max(maxLoadedPieces, t.pieces);
+    return true;
+}
+
+int Tablebase::load(const std::string &dir) {
+    int loaded = 0;
+    for (const std::string &name : allMaterials())
+        if (loadTable(dir, name)) ++loaded;
+    return loaded;
+}
+
+const Tablebase::Table *Tablebase::findTable(const std::string &name) const {
+    auto it = tables.find(name);
+    return (it == tables.end()) ? nullptr : &it->second;
+}
+
+// Looks a position up in whichever table covers it. Returns the entry code
+// (WDL_*) from the side to move's view, or WDL_UNKNOWN if no table is loaded.
+class TablebaseGenerator {
+public:
+    static uint8_t lookup(const Tablebase &tb, TbPos pos, uint8_t *dtz = nullptr) {
+        if (pos.n == 2) { // bare kings
+            if (dtz) *dtz = 0;
+            return WDL_DRAW;
+        }
+        const Tablebase::Table *t = tb.findTable(canonicalize(pos));
+        if (!t) return WDL_UNKNOWN;
+        uint64_t idx = encode(pos);
+        if (dtz) *dtz = t->dtz[idx];
+        return readWdl(t->wdl, idx);
+    }
+
+    static bool build(Tablebase &tb, const std::string &dir, const std::string &name,
+                      int threads, std::string &summary);
+};
+
+bool Tablebase::probeWDL(const Board &board, int &wdl) const {
+    int dtz;
+    return probe(board, wdl, dtz);
+}
+
+bool Tablebase::probe(const Board &board, int &wdl, int &dtz) const {
+    if (tables.empty()) return false;
+
+    TbPos pos;
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            char c = board.squares[y][x];
+            if (c == '.') continue;
+            if (pos.n == maxLoadedPieces) return false;
+            pos.p[pos.n++] = { typeFromChar(c), std::isupper(static_cast<unsigned char>(c)) != 0, y * 8 + x };
+        }
+    }
+    pos.whiteToMove = (board.currentPlayer == 'W');
+
+    // Tables know nothing about castling rights
+    if (!board.whiteKingMoved && board.squares[7][4] == 'K' &&
+        ((!board.whiteRookMoved[0] && board.squares[7][0] == 'R') ||
+         (!board.whiteRookMoved[1] && board.squares[7][7] == 'R')))
+        return false;
+    if (!board.blackKingMoved && board.squares[0][4] == 'k' &&
+        ((!board.blackRookMoved[0] && board.squares[0][0] == 'r') ||
+         (!board.blackRookMoved[1] && board.squares[0][7] == 'r')))
+        return false;
+
+    // ...or en passant: bail out only if a capture is actually available
+    if (board.enPassantX != -1) {
+        int pawnRow = board.enPassantY + (pos.whiteToMove ? 1 : -1);
+        char capturer = pos.whiteToMove ? 'P' : 'p';
+        for (int dx = -1; dx <= 1; dx += 2) {
+            int x = board.enPassantX + dx;
+            if (x >= 0 && x < 8 && pawnRow >= 0 && pawnRow < 8 && board.squares[pawnRow][x] == capturer)
+                return false;
+        }
+    }
+
+    uint8_t d = 0;
+    uint8_t code = TablebaseGenerator::lookup(*this, pos, &d);
+    switch (code) {
+        case WDL_WIN:  wdl = TB_WIN; break;
+        case WDL_LOSS: wdl = TB_LOSS; break;
+        case WDL_DRAW: wdl = TB_DRAW; break;
+        default: return false;
+    }
+    dtz = (wdl == TB_DRAW || d == DTZ_NONE) ? 0 : d;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Generation
+
+std::vector<std::string> Tablebase::allMaterials(int maxPieces) {
+    // Every way to hand one or two extra men to the two sides, canonicalised
+    std::set<std::string> names;
+    for (int a = QUEEN; a <= PAWN; ++a) {
+        for (int b = QUEEN - 1; b <= PAWN; ++b) {      // b == KING means "no second piece"
+            for (int side = 0; side < 2; ++side) {
+                TbPos pos;
+                pos.p[pos.n++] = { KING, true, 0 };
+                pos.p[pos.n++] = { KING, false, 0 };
+                pos.p[pos.n++] = { a, true, 0 };
+                if (b != KING) pos.p[pos.n++] = { b, side == 0, 0 };
+                if (pos.n <= maxPieces) names.insert(canonicalize(pos));
+            }
+        }
+    }
+
+    // Captures need the smaller tables, promotions the ones with fewer pawns
+    std::vector<std::string> order(names.begin(), names.end());
+    auto key = [](const std::string &s) {
+        return std::make_pair(s.size(), std::count(s.begin(), s.end(), 'P'));
+    };
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const std::string &a, const std::string &b) { return key(a) < key(b); });
+    return order;
+}
+
+namespace {
+
+// Runs fn(begin, end, threadIndex) over [0, count) split across threads
+template <class Fn>
+void parallelFor(uint64_t count, int threads, Fn &&fn) {
+    std::vector<std::thread> pool;
+    uint64_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        uint64_t begin = t * chunk, end = std::min(count, begin + chunk);
+        if (begin >= end) break;
+        pool.emplace_back([&fn, begin, end, t] { fn(begin, end, t); });
+    }
+    for (auto &th : pool) th.join();
+}
+
+bool writeTable(const std::string &path, const char magic[8], int pieces,
+                const std::vector<uint8_t> &data) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    uint32_t header[2] = { static_cast<uint32_t>(pieces), 0 };
+    out.write(magic, 8);
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+bool TablebaseGenerator::build(Tablebase &tb, const std::string &dir, const std::string &name,
+                               int threads, std::string &summary) {
+    TbPos layout;
+    if (!parseMaterial(name, layout)) return false;
+    const uint64_t size = tableSize(layout.n);
+
+    std::vector<uint8_t> state(size, WDL_UNKNOWN);
+    std::vector<uint8_t> count(size, 0);  // moves not yet known to lose for us
+    std::vector<uint8_t> dtz(size, DTZ_NONE);
+    std::atomic<bool> missingTable{ false };
+
+    auto at = [](std::vector<uint8_t> &v, uint64_t i) { return std::atomic_ref<uint8_t>(v[i]); };
+
+    // Pass 1: mates, stalemates and everything decided by a capture/promotion.
+    // count = same-table moves still open; a drawing conversion adds 128 so
+    // the position can never be proven lost.
+    parallelFor(size, threads, [&](uint64_t begin, uint64_t end, int) {
+        TbPos pos;
+        for (uint64_t idx = begin; idx < end; ++idx) {
+            decode(idx, layout, pos);
+            if (!isValid(pos)) { state[idx] = WDL_INVALID; continue; }
+
+            int moves = 0, open = 0;
+            bool win = false, escape = false;
+            forEachMove(pos, [&](const TbPos &child, bool, bool conversion) {
+                ++moves;
+                if (!conversion) { ++open; return; }
+                uint8_t r = lookup(tb, child);
+                if (r == WDL_LOSS) win = true;
+                else if (r == WDL_DRAW) escape = true;
+                else if (r != WDL_WIN) missingTable = true;
+            });
+
+            if (moves == 0) {
+                bool mated = isAttacked(pos, kingSquare(pos, pos.whiteToMove), !pos.whiteToMove);
+                state[idx] = mated ? WDL_LOSS : WDL_DRAW;
+                if (mated) dtz[idx] = 0;
+            } else if (win) {
+                state[idx] = WDL_WIN;
+            } else if (open == 0 && !escape) {
+                state[idx] = WDL_LOSS; // every move converts into a lost ending
+            } else {
+                count[idx] = static_cast<uint8_t>(open + (escape ? 128 : 0));
+            }
+        }
+    });
+    if (missingTable) return false;
+
+    // Pass 2: retrograde WDL. Each newly decided position updates the
+    // same-table positions one quiet move before it.
+    std::vector<uint32_t> frontier;
+    for (uint64_t i = 0; i < size; ++i)
+        if (state[i] == WDL_WIN || state[i] == WDL_LOSS) frontier.push_back(static_cast<uint32_t>(i));
+
+    auto expand = [&](const std::vector<uint32_t> &from, auto &&visit) {
+        std::vector<std::vector<uint32_t>> local(threads);
+        parallelFor(from.size(), threads, [&](uint64_t begin, uint64_t end, int t) {
+            TbPos pos;
+            for (uint64_t k = begin; k < end; ++k) {
+                uint64_t idx = from[k];
+                decode(idx, layout, pos);
+                forEachUnmove(pos, [&](const TbPos &parent, bool zeroing) {
+                    uint64_t p = encode(parent);
+                    if (visit(idx, p, zeroing)) local[t].push_back(static_cast<uint32_t>(p));
+                });
+            }
+        });
+        std::vector<uint32_t> next;
+        for (auto &l : local) next.insert(next.end(), l.begin(), l.end());
+        return next;
+    };
+
+    while (!frontier.empty()) {
+        frontier = expand(frontier, [&](uint64_t child, uint64_t p, bool) {
+            uint8_t expected = WDL_UNKNOWN;
+            if (state[child] == WDL_LOSS)
+                return at(state, p).compare_exchange_strong(expected, WDL_WIN);
+            if (at(state, p).load(std::memory_order_relaxed) != WDL_UNKNOWN) return false;
+            if (at(count, p).fetch_sub(1) != 1) return false;
+            return at(state, p).compare_exchange_strong(expected, WDL_LOSS);
+        });
+    }
+
+    // Whatever retrograde analysis could not decide is a draw
+    std::replace(state.begin(), state.end(), static_cast<uint8_t>(WDL_UNKNOWN), static_cast<uint8_t>(WDL_DRAW));
+
+    // Pass 3: DTZ setup. Wins with a zeroing move into a lost position are
+    // dtz 1; losses count the quiet moves whose dtz is still open.
+    parallelFor(size, threads, [&](uint64_t begin, uint64_t end, int) {
+        TbPos pos;
+        for (uint64_t idx = begin; idx < end; ++idx) {
+            if (state[idx] != WDL_WIN && (state[idx] != WDL_LOSS || dtz[idx] == 0)) continue;
+
+            decode(idx, layout, pos);
+            int quiet = 0;
+            bool zeroWin = false;
+            forEachMove(pos, [&](const TbPos &child, bool zeroing, bool conversion) {
+                if (!zeroing) { ++quiet; return; }
+                uint8_t r = conversion ? lookup(tb, child) : state[encode(child)];
+                if (r == WDL_LOSS) zeroWin = true;
+            });
+            if (state[idx] == WDL_WIN) {
+                if (zeroWin) dtz[idx] = 1;
+            } else {
+                count[idx] = static_cast<uint8_t>(quiet);
+                if (quiet == 0) dtz[idx] = 1;
+            }
+        }
+    });
+
+    // Pass 4: retrograde DTZ, one level per ply so the first value set is final
+    std::vector<uint32_t> levels[2];
+    for (uint64_t i = 0; i < size; ++i)
+        if (dtz[i] <= 1) levels[dtz[i]].push_back(static_cast<uint32_t>(i));
+
+    frontier = levels[0];
+    int maxDtz = 0;
+    for (int d = 0; d <= 1 || !frontier.empty(); ++d) {
+        if (d == 1) frontier.insert(frontier.end(), levels[1].begin(), levels[1].end());
+        if (!frontier.empty()) maxDtz = d;
+        uint8_t nextDtz = static_cast<uint8_t>(std::min(d + 1, static_cast<int>(DTZ_MAX)));
+        frontier = expand(frontier, [&](uint64_t child, uint64_t p, bool zeroing) {
+            if (zeroing) return false;
+            uint8_t expected = DTZ_NONE;
+            if (state[child] == WDL_LOSS && state[p] == WDL_WIN)
+                return at(dtz, p).compare_exchange_strong(expected, nextDtz);
+            if (state[child] == WDL_WIN && state[p] == WDL_LOSS &&
+                at(dtz, p).load(std::memory_order_relaxed) == DTZ_NONE &&
+                at(count, p).fetch_sub(1) == 1)
+                return at(dtz, p).compare_exchange_strong(expected, nextDtz);
+            return false;
+        });
+    }
+
+    // Write .wdl (packed) and .dtz, then map them for the tables that follow
+    std::vector<uint8_t> packed(size / 4, 0);
+    uint64_t wins = 0, losses = 0, draws = 0;
+    for (uint64_t i = 0; i < size; ++i) {
+        packed[i >> 2] |= static_cast<uint8_t>(state[i] << ((i & 3) * 2));
+        if (state[i] == WDL_WIN) ++wins;
+        else if (state[i] == WDL_LOSS) ++losses;
+        else if (state[i] == WDL_DRAW) ++draws;
+    }
+    if (!writeTable(dir + "/" + name + ".wdl", WDL_MAGIC, layout.n, packed) ||
+        !writeTable(dir + "/" + name + ".dtz", DTZ_MAGIC, layout.n, dtz))
+        return false;
+
+    summary = name + ": " + std::to_string(wins) + " wins, " + std::to_string(losses) + " losses, " +
+              std::to_string(draws) + " draws, max dtz " + std::to_string(maxDtz);
+    return tb.loadTable(dir, name);
+}
+
+bool Tablebase::generate(const std::string &dir, int threads, int maxPieces,
+                         const std::function<void(const std::string &)> &progress) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    Tablebase tb;
+    for (const std::string &name : allMaterials(maxPieces)) {
+        if (tb.loadTable(dir, name)) {
+            if (progress) progress(name + ": already present");
+            continue;
+        }
+        std::string summary;
+        if (!TablebaseGenerator::build(tb, dir, name, threads, summary)) {
+            if (progress) progress(name + ": generation failed");
+            return false;
+        }
+        if (progress) progress(summary);
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#include "TranspositionTable.hpp"
+#include <functional>
+
+LocalTranspositionTable::LocalTranspositionTable(std::size_t maxEntries)
+    : maxPerShard(maxEntries ? (maxEntries + SHARDS - 1) / SHARDS : 0) {}
+
+LocalTranspositionTable::Shard &LocalTranspositionTable::shardFor(const std::string &key) {
+    return shards[std::hash<std::string>{}(key) % SHARDS];
+}
+
+const LocalTranspositionTable::Shard &LocalTranspositionTable::shardFor(const std::string &key) const {
+    return shards[std::hash<std::string>{}(key) % SHARDS];
+}
+
+bool LocalTranspositionTable::probe(const std::string &key, Entry &out) const {
+    const Shard &s = shardFor(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it == s.map.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void LocalTranspositionTable::store(const std::string &key, const Entry &entry) {
+    Shard &s = shardFor(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    // crude replacement: a full shard starts over
+    if (maxPerShard && s.map.size() >= maxPerShard && s.map.find(key) == s.map.end()) s.map.clear();
+    s.map[key] = entry;
+}
+
+void LocalTranspositionTable::clear() {
+    for (Shard &s : shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.map.clear();
+    }
+}
+
+std::size_t LocalTranspositionTable::size() const {
+    std::size_t n = 0;
+    for (const Shard &s : shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        n += s.map.size();
+    }
+    return n;
+}
@@ -0,0 +1,188 @@
+#include "Board.hpp"
+#include "AIPlayer.hpp"
+#include "EvalCache.hpp"
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Annotates recorded games (the moves.txt format: one "e2e4" move per line)
+// with engine scores. Every position is searched for a fixed time; the move
+// actually played is then scored from the same root to the depth that search
+// reached, and its loss against the best move is flagged when it is big.
+// Comparing at one depth keeps the odd/even horizon swing out of the loss.
+//
+// Positions are handed out in runs of consecutive plies of one game, so a
+// worker's transposition table (its own, kept across runs) already holds
+// the previous ply's search when it starts the next one.
+//
+// Usage: annotate <game files...> [--movetime MS] [--threads N] [--chunk N]
+//                 [--blunder PAWNS] [--mistake PAWNS]
+
+namespace {
+
+struct Game {
+    std::string file;
+    std::vector<std::string> moves;
+    std::vector<Board> positions;        // before each move, plus the final one
+    std::vector<double> best, played;    // side to move's view, in pawns
+    std::vector<std::string> bestMoves;
+    std::vector<char> analysed;          // false if the search finished no depth
+    std::string error;
+};
+
+struct Chunk {
+    std::size_t game;
+    std::size_t first, last;             // positions [first, last)
+};
+
+bool loadGame(const std::string &path, Game &game) {
+    game.file = path;
+    std::ifstream in(path);
+    if (!in) {
+        game.error = "cannot open file";
+        return false;
+    }
+    Board board;
+    game.positions.push_back(board);
+    std::string move;
+    while (in >> move) {
+        if (!board.makeMove(move)) {
+            game.error = "illegal move " + move + " at ply " + std::to_string(game.moves.size() + 1);
+            break; // annotate what came before it
+        }
+        game.moves.push_back(move);
+        game.positions.push_back(board);
+    }
+    game.best.assign(game.moves.size(), 0.0);
+    game.played.assign(game.moves.size(), 0.0);
+    game.bestMoves.assign(game.moves.size(), "");
+    game.analysed.assign(game.moves.size(), 0);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> files;
+    double movetimeMs = 1000.0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::size_t chunkPlies = 16;
+    double blunder = 2.0, mistake = 0.8;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            files.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) break;
+        if (arg == "--movetime") movetimeMs = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--threads") threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--chunk") chunkPlies = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--blunder") blunder = std::atof(argv[++i]);
+        else if (arg == "--mistake") mistake = std::atof(argv[++i]);
+        else ++i;
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: annotate <game files...> [--movetime MS] [--threads N] [--chunk N]\n"
+                     "                [--blunder PAWNS] [--mistake PAWNS]\n";
+        return 1;
+    }
+
+    std::vector<Game> games(files.size());
+    std::vector<Chunk> chunks;
+    for (std::size_t g = 0; g < files.size(); ++g) {
+        if (!loadGame(files[g], games[g])) continue;
+        std::size_t n = games[g].moves.size();
+        for (std::size_t first = 0; first < n; first += chunkPlies)
+            chunks.push_back({ g, first, std::min(n, first + chunkPlies) });
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    std::mutex printMutex;
+    SearchLimits limits;
+    limits.movetimeMs = movetimeMs;
+
+    auto worker = [&]() {
+        // One table per worker, shared by its two players and kept across runs.
+        // No root bias, so runSearch scores compare with searchRootMove's
+        auto tt = std::make_shared<LocalTranspositionTable>(1u << 20);
+        auto cache = std::make_shared<EvalCache>(1u << 18);
+        AIPlayer white('W', 1), black('B', 1);
+        for (AIPlayer *ai : { &white, &black }) {
+            ai->setTranspositionTable(tt);
+            ai->setEvalCache(cache);
+            ai->setRandomBias(false);
+        }
+
+        for (std::size_t c = next++; c < chunks.size(); c = next++) {
+            Game &game = games[chunks[c].game];
+            for (std::size_t i = chunks[c].first; i < chunks[c].last; ++i) {
+                const Board &board = game.positions[i];
+                AIPlayer &ai = board.getCurrentPlayer() == 'W' ? white : black;
+                SearchResult r = ai.runSearch(board, limits);
+                if (r.stats.depths.empty()) continue; // no score to compare against
+                game.analysed[i] = 1;
+                game.best[i] = game.played[i] = r.score;
+                game.bestMoves[i] = r.bestMove;
+                if (game.moves[i] != r.bestMove)
+                    ai.searchRootMove(board, game.moves[i], r.stats.depths.back().depth, game.played[i]);
+            }
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cerr << "[" << game.file << "] plies " << chunks[c].first + 1 << "-" << chunks[c].last << " done\n";
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for (auto &th : pool) th.join();
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - t0;
+
+    // One line per move: scores are the mover's view, in pawns
+    std::size_t positions = 0;
+    std::cout << std::fixed << std::setprecision(2) << std::showpos;
+    for (const Game &game : games) {
+        std::cout << "# " << game.file << "\n";
+        if (!game.error.empty()) std::cout << "# error: " << game.error << "\n";
+        int blunders = 0, mistakes = 0, skipped = 0;
+        for (std::size_t i = 0; i < game.moves.size(); ++i) {
+            if (!game.analysed[i]) {
+                ++skipped;
+                std::cout << std::noshowpos << std::setw(4) << i + 1 << " " << game.positions[i].getCurrentPlayer()
+                          << " " << std::left << std::setw(6) << game.moves[i] << std::right
+                          << " not analysed (no depth finished)\n" << std::showpos;
+                continue;
+            }
+            double best = game.best[i], played = game.played[i];
+            double loss = std::max(0.0, best - played);
+            const char *flag = loss >= blunder ? "??" : loss >= mistake ? "?" : "";
+            blunders += loss >= blunder;
+            mistakes += loss >= mistake && loss < blunder;
+
+            std::cout << std::noshowpos << std::setw(4) << i + 1 << " " << game.positions[i].getCurrentPlayer() << " "
+                      << std::left << std::setw(6) << game.moves[i] << std::right << std::showpos
+                      << " played " << std::setw(8) << played << "  best " << std::left << std::setw(6)
+                      << game.bestMoves[i] << std::right << std::setw(8) << best << std::noshowpos
+                      << "  loss " << std::setw(6) << loss << "  " << flag << "\n" << std::showpos;
+        }
+        std::cout << std::noshowpos << "# " << game.moves.size() << " moves, " << mistakes << " mistakes, "
+                  << blunders << " blunders";
+        if (skipped) std::cout << ", " << skipped << " not analysed";
+        std::cout << "\n\n" << std::showpos;
+        positions += game.moves.size();
+    }
+    std::cout << std::noshowpos;
+    std::cerr << std::fixed << std::setprecision(1) << "Annotated " << games.size() << " games, " << positions
+              << " positions in " << wall.count() << " s with " << threads << " threads\n";
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "Board.hpp"
+#include "AIPlayer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Microbenchmarks for the Board / AIPlayer primitives the search spends its
+// time in. Every primitive runs over the same fixed positions; each sample
+// times enough calls to last ~samplems, and the report gives ns per call.
+// Usage: bench_micro [--json] [--samples N] [--sample-ms N] [--filter name]
+
+namespace {
+
+const char *POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+    "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKR b - - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+struct Stats {
+    std::string name;
+    uint64_t callsPerSample = 0;
+    std::vector<double> nsPerCall;
+    double median = 0, mean = 0, stddev = 0, min = 0, max = 0, ci95 = 0;
+};
+
+void summarize(Stats &s) {
+    std::vector<double> v = s.nsPerCall;
+    std::sort(v.begin(), v.end());
+    std::size_t n = v.size();
+    s.min = v.front();
+    s.max = v.back();
+    s.median = (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+    double sum = 0;
+    for (double x : v) sum += x;
+    s.mean = sum / n;
+    double var = 0;
+    for (double x : v) var += (x - s.mean) * (x - s.mean);
+    s.stddev = (n > 1) ? std::sqrt(var / (n - 1)) : 0.0;
+    s.ci95 = 1.96 * s.stddev / std::sqrt(static_cast<double>(n));
+}
+
+volatile uint64_t sink; // keeps results observable so calls are not optimised away
+
+} // namespace
+
+// Friend of Board and AIPlayer, so the private primitives can be timed directly
+class MicroBench {
+public:
+    struct Case {
+        std::string name;
+        std::function<uint64_t()> pass; // one pass over all positions; returns calls made
+    };
+
+    static std::vector<Case> cases(const std::vector<Board> &boards) {
+        // Inputs are precomputed so only the primitive itself is timed
+        std::vector<std::vector<std::string>> candidates(boards.size()), legal(boards.size());
+        for (std::size_t i = 0; i < boards.size(); ++i) {
+            const Board &b = boards[i];
+            for (int fy = 0; fy < 8; ++fy)
+                for (int fx = 0; fx < 8; ++fx) {
+                    char p = b.squares[fy][fx];
+                    if (p == '.' || !b.isCorrectPlayerMove(p)) continue;
+                    for (int ty = 0; ty < 8; ++ty)
+                        for (int tx = 0; tx < 8; ++tx) {
+                            std::string mv = std::string() + char('a' + fx) + char('8' - fy)
+                                             + char('a' + tx) + char('8' - ty);
+                            candidates[i].push_back(mv);
+                            if (b.isMoveValid(mv)) legal[i].push_back(mv);
+                        }
+                }
+        }
+
+        std::vector<Case> out;
+        out.push_back({ "Board::validateMove", [&boards, candidates] {
+            uint64_t calls = 0, acc = 0;
+            for (std::size_t i = 0; i < boards.size(); ++i)
+                for (const std::string &mv : candidates[i]) { acc += boards[i].validateMove(mv).size(); ++calls; }
+            sink = acc;
+            return calls;
+        } });
+        out.push_back({ "Board::isSquareAttacked", [&boards] {
+            uint64_t calls = 0, acc = 0;
+            for (const Board &b : boards)
+                for (int sq = 0; sq < 64; ++sq)
+                    for (int white = 0; white < 2; ++white) { acc += b.isSquareAttacked(sq % 8, sq / 8, white); ++calls; }
+            sink = acc;
+            return calls;
+        } });
+        out.push_back({ "Board::isInCheck", [&boards] {
+            uint64_t calls = 0, acc = 0;
+            for (const Board &b : boards) { acc += b.isInCheck('W') + b.isInCheck('B'); calls += 2; }
+            sink = acc;
+            return calls;
+        } });
+        out.push_back({ "Board::makeMove", [&boards, legal] {
+            uint64_t calls = 0, acc = 0;
+            for (std::size_t i = 0; i < boards.size(); ++i)
+                for (const std::string &mv : legal[i]) {
+                    Board copy = boards[i];  // the search copies before every makeMove too
+                    acc += copy.makeMove(mv);
+                    ++calls;
+                }
+            sink = acc;
+            return calls;
+        } });
+        // One player for all AIPlayer cases: its constructor allocates the
+        // transposition table and caches, which must stay out of the timings
+        auto ai = std::make_shared<AIPlayer>('W');
+        out.push_back({ "AIPlayer::generateAllLegalMoves", [&boards, ai] {
+            uint64_t calls = 0, acc = 0;
+            for (const Board &b : boards) {
+                Board copy = b;
+                acc += ai->generateAllLegalMoves(copy, b.getCurrentPlayer()).size();
+                ++calls;
+            }
+            sink = acc;
+            return calls;
+        } });
+        out.push_back({ "AIPlayer::evaluateBoard", [&boards, ai] {
+            uint64_t calls = 0;
+            double acc = 0;
+            for (const Board &b : boards) { acc += ai->evaluateBoard(b); ++calls; }
+            sink = static_cast<uint64_t>(acc);
+            return calls;
+        } });
+        out.push_back({ "AIPlayer::boardKey", [&boards, ai] {
+            uint64_t calls = 0, acc = 0;
+            for (const Board &b : boards) { acc += ai->boardKey(b).size(); ++calls; }
+            sink = acc;
+            return calls;
+        } });
+        return out;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    bool json = false;
+    int samples = 15;
+    double sampleMs = 50.0;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") json = true;
+        else if (arg == "--samples" && i + 1 < argc) samples = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "--sample-ms" && i + 1 < argc) sampleMs = std::atof(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+    }
+
+    std::vector<Board> boards;
+    for (const char *fen : POSITIONS) {
+        Board b;
+        b.loadFEN(fen);
+        boards.push_back(b);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<Stats> results;
+    for (const MicroBench::Case &c : MicroBench::cases(boards)) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+
+        // Calibrate: how many passes fill one sample (after one warm-up pass)
+        c.pass();
+        auto t0 = Clock::now();
+        uint64_t callsPerPass = c.pass();
+        double passNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        int passes = std::max(1, static_cast<int>(sampleMs * 1e6 / std::max(passNs, 1.0)));
+
+        Stats s;
+        s.name = c.name;
+        s.callsPerSample = callsPerPass * passes;
+        for (int k = 0; k < samples; ++k) {
+            auto start = Clock::now();
+            for (int p = 0; p < passes; ++p) c.pass();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            s.nsPerCall.push_back(ns / s.callsPerSample);
+        }
+        summarize(s);
+        results.push_back(s);
+    }
+
+    if (json) {
+        std::cout << std::fixed << std::setprecision(2) << "{\n  \"positions\": " << boards.size()
+                  << ",\n  \"samples\": " << samples << ",\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Stats &s = results[i];
+            std::cout << "    {\"name\": \"" << s.name << "\", \"calls_per_sample\": " << s.callsPerSample
+                      << ", \"median_ns\": " << s.median << ", \"mean_ns\": " << s.mean
+                      << ", \"stddev_ns\": " << s.stddev << ", \"ci95_ns\": " << s.ci95
+                      << ", \"min_ns\": " << s.min << ", \"max_ns\": " << s.max << "}"
+                      << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        std::cout << "  ]\n}\n";
+        return 0;
+    }
+
+    std::cout << std::left << std::setw(34) << "benchmark" << std::right << std::setw(12) << "median ns"
+              << std::setw(12) << "mean ns" << std::setw(10) << "+/- 95%" << std::setw(12) << "min ns"
+              << std::setw(12) << "max ns" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (const Stats &s : results) {
+        std::cout << std::left << std::setw(34) << s.name << std::right << std::setw(12) << s.median
+                  << std::setw(12) << s.mean << std::setw(10) << s.ci95 << std::setw(12) << s.min
+                  << std::setw(12) << s.max << "\n";
+    }
+    std::cout << "\n" << boards.size() << " positions, " << samples << " samples of ~" << sampleMs
+              << " ms each\n";
+    return 0;
+}
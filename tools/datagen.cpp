@@ -0,0 +1,185 @@
+#include "Board.hpp"
+#include "AIPlayer.hpp"
+#include "EvalCache.hpp"
+#include "PackedPosition.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless self-play for training data. Every worker thread plays whole
+// games, each move searched to a fixed node budget, and hands the finished
+// game's positions to one writer; every position is stored with its search
+// score and the game's result as a 32-byte PackedPosition, in compressed
+// blocks. A few random opening plies keep the games apart.
+//
+//   datagen <out.bin> [--games N] [--threads N] [--nodes N] [--random-plies N] [--max-plies N]
+//   datagen --dump <file.bin> [--limit N]     print "<FEN> | score | result" lines
+
+namespace {
+
+// A position has at most 218 legal moves and depth 1 costs one node each
+// plus the root, so smaller budgets may not finish a single iteration
+constexpr uint64_t MIN_NODES = 256;
+
+struct Options {
+    int games = 100;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    uint64_t nodes = 5000;
+    int randomPlies = 8;
+    int maxPlies = 400;      // adjudicated a draw after this many plies
+};
+
+struct Game {
+    std::vector<PackedPosition> positions;
+    int result = 0;          // White's view
+};
+
+Game playGame(const Options &opt, std::mt19937 &rng, const std::shared_ptr<EvalCache> &cache) {
+    Game game;
+    Board board;
+    // No root bias: its random bonuses and king-move penalty would end up in
+    // the stored scores, and the random opening plies already vary the games
+    AIPlayer white('W', 1), black('B', 1);
+    for (AIPlayer *ai : { &white, &black }) {
+        ai->setEvalCache(cache);
+        ai->setRandomBias(false);
+    }
+    SearchLimits limits;
+    limits.nodes = opt.nodes;
+
+    std::vector<std::pair<Board, double>> searched; // positions and side-to-move scores
+    for (int ply = 0; ply < opt.maxPlies; ++ply) {
+        std::vector<std::string> moves = board.legalMoves();
+        char side = board.getCurrentPlayer();
+        if (moves.empty()) {
+            if (board.isInCheck(side)) game.result = side == 'W' ? -1 : 1;
+            break;
+        }
+        if (board.getHalfmoveClock() >= 100) break; // fifty-move rule
+
+        std::string move;
+        if (ply < opt.randomPlies) {
+            move = moves[rng() % moves.size()];
+        } else {
+            AIPlayer &ai = side == 'W' ? white : black;
+            SearchResult r = ai.runSearch(board, limits);
+            if (r.bestMove.empty()) break;
+            // no finished depth means no score to label the position with
+            if (!r.stats.depths.empty()) searched.emplace_back(board, r.score);
+            move = r.bestMove;
+        }
+        board.makeMove(move);
+    }
+
+    game.positions.reserve(searched.size());
+    for (const auto &[pos, score] : searched)
+        game.positions.push_back(PackedPosition::pack(pos, score, game.result));
+    return game;
+}
+
+int dump(const std::string &path, uint64_t limit) {
+    PackedReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "Cannot open " << path << "\n";
+        return 1;
+    }
+    std::vector<PackedPosition> block;
+    uint64_t shown = 0;
+    while (shown < limit && reader.readBlock(block))
+        for (const PackedPosition &p : block) {
+            if (shown++ == limit) break;
+            std::cout << p.toFEN() << " | " << p.score << " | " << int(p.result) << "\n";
+        }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: datagen <out.bin> [--games N] [--threads N] [--nodes N] [--random-plies N] [--max-plies N]\n"
+                     "       datagen --dump <file.bin> [--limit N]\n";
+        return 1;
+    }
+    if (std::string(argv[1]) == "--dump") {
+        if (argc < 3) {
+            std::cerr << "Usage: datagen --dump <file.bin> [--limit N]\n";
+            return 1;
+        }
+        uint64_t limit = UINT64_MAX;
+        if (argc >= 5 && std::string(argv[3]) == "--limit") limit = std::strtoull(argv[4], nullptr, 10);
+        return dump(argv[2], limit);
+    }
+
+    Options opt;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--games") opt.games = std::atoi(argv[i + 1]);
+        else if (arg == "--threads") opt.threads = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--nodes") opt.nodes = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--random-plies") opt.randomPlies = std::max(0, std::atoi(argv[i + 1]));
+        else if (arg == "--max-plies") opt.maxPlies = std::max(1, std::atoi(argv[i + 1]));
+    }
+
+    if (opt.nodes < MIN_NODES) {
+        std::cerr << "--nodes must be at least " << MIN_NODES << " to finish a depth-1 search\n";
+        return 1;
+    }
+
+    PackedWriter writer;
+    if (!writer.open(argv[1])) {
+        std::cerr << "Cannot write " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::atomic<int> nextGame{ 0 };
+    std::mutex writeMutex;
+    int finished = 0;
+    int results[3] = { 0, 0, 0 }; // black wins, draws, white wins
+    auto t0 = std::chrono::steady_clock::now();
+
+    auto worker = [&](unsigned seed) {
+        std::mt19937 rng(seed);
+        auto cache = std::make_shared<EvalCache>(1u << 18); // per thread, reused across games
+        while (nextGame++ < opt.games) {
+            Game game = playGame(opt, rng, cache);
+
+            std::lock_guard<std::mutex> lock(writeMutex);
+            for (const PackedPosition &p : game.positions) writer.write(p);
+            ++results[game.result + 1];
+            if (++finished % 10 == 0 || finished == opt.games) {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+                std::cout << "[" << static_cast<int>(elapsed.count()) << "s] games " << finished << "/" << opt.games
+                          << "  positions " << writer.positions() << "  ("
+                          << static_cast<long long>(writer.positions() / std::max(elapsed.count(), 1e-3)) << "/s)"
+                          << std::endl;
+            }
+        }
+    };
+
+    std::random_device rd;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < opt.threads; ++t) pool.emplace_back(worker, rd());
+    for (auto &th : pool) th.join();
+    if (!writer.close()) {
+        std::cerr << "Error writing " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - t0;
+    std::cout << std::fixed << std::setprecision(1)
+              << "Games: " << finished << " (+" << results[2] << " =" << results[1] << " -" << results[0] << ")"
+              << "   positions: " << writer.positions() << "   time: " << wall.count() << " s\n"
+              << "Written: " << writer.bytes() << " bytes ("
+              << (writer.positions() ? double(writer.bytes()) / writer.positions() : 0.0) << " per position, 32 unpacked)\n";
+    return 0;
+}
@@ -0,0 +1,487 @@
+#include "Board.hpp"
+#include "AIPlayer.hpp"
+#include "Tablebase.hpp"
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Root-split search across processes. A coordinator runs iterative deepening
+// itself but hands every root move of every iteration to a pool of worker
+// processes over TCP, one move per worker at a time. A worker that is still
+// busy long after the others have finished gets its move duplicated onto an
+// idle worker; the first answer wins and the other copy is stopped.
+//
+//   distsearch worker [--port N] [--tb dir]
+//   distsearch coordinator (--workers host:port,... | --spawn N [--port-base P])
+//                          [--depth N] [--slow-factor X] fen <FEN>
+//
+// Worker protocol (one line each way):
+//   search <id> depth <D> move <mv> fen <FEN>  ->  result <id> <score> <nodes>
+//   stop <id>                                  ->  stopped <id>   (if still running)
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool sendLine(int fd, const std::string &line) {
+    std::string out = line + "\n";
+    for (std::size_t off = 0; off < out.size();) {
+        ssize_t n = ::send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Append what is readable to buffer and split off complete lines; false on EOF
+bool readLines(int fd, std::string &buffer, std::vector<std::string> &lines) {
+    char chunk[4096];
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) return false;
+    buffer.append(chunk, static_cast<std::size_t>(n));
+    std::size_t nl;
+    while ((nl = buffer.find('\n')) != std::string::npos) {
+        lines.push_back(buffer.substr(0, nl));
+        buffer.erase(0, nl + 1);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- worker
+
+// One connection runs one root move at a time; a new request stops the old one
+class WorkerConnection {
+public:
+    WorkerConnection(int fd_, std::shared_ptr<TranspositionTable> tt_, const Tablebase *tb)
+        : fd(fd_), tt(std::move(tt_)), tablebase(tb) {}
+
+    ~WorkerConnection() {
+        job = std::jthread(); // stop and join before the socket goes away
+        ::close(fd);
+    }
+
+    void serve() {
+        std::string buffer;
+        std::vector<std::string> lines;
+        while (readLines(fd, buffer, lines)) {
+            for (const std::string &line : lines) handle(line);
+            lines.clear();
+        }
+    }
+
+private:
+    int fd;
+    std::shared_ptr<TranspositionTable> tt;
+    const Tablebase *tablebase;
+    std::mutex writeMutex;
+    std::string jobId;
+    std::jthread job;
+
+    void reply(const std::string &line) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        sendLine(fd, line);
+    }
+
+    void handle(const std::string &line) {
+        std::istringstream in(line);
+        std::string cmd, id;
+        in >> cmd >> id;
+        if (cmd == "stop") {
+            if (id == jobId) job.request_stop();
+            return;
+        }
+        if (cmd != "search") {
+            reply("error unknown command '" + cmd + "'");
+            return;
+        }
+
+        int depth = 1;
+        std::string word, move, fen;
+        while (in >> word) {
+            if (word == "depth") in >> depth;
+            else if (word == "move") in >> move;
+            else if (word == "fen") {
+                std::getline(in >> std::ws, fen);
+                break;
+            }
+        }
+        Board board;
+        if (!board.loadFEN(fen) || !board.isMoveValid(move)) {
+            reply("error " + id + " bad position or move");
+            return;
+        }
+
+        job = std::jthread(); // a worker only ever owes one answer
+        jobId = id;
+        job = std::jthread([this, id, board, move, depth](std::stop_token stop) {
+            AIPlayer ai(board.getCurrentPlayer(), depth);
+            ai.setTranspositionTable(tt);
+            if (tablebase) ai.setTablebase(tablebase);
+            double score = 0.0;
+            if (ai.searchRootMove(board, move, depth, score, stop)) {
+                std::ostringstream out;
+                out << "result " << id << " " << std::setprecision(10) << score << " " << ai.lastSearchStats().nodes;
+                reply(out.str());
+            } else {
+                reply("stopped " + id);
+            }
+        });
+    }
+};
+
+int runWorker(int port, const Tablebase *tablebase) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        std::cerr << "worker: cannot listen on port " << port << "\n";
+        return 1;
+    }
+
+    // All connections of this worker share its transposition table
+    auto tt = std::make_shared<LocalTranspositionTable>(4000000);
+    for (;;) {
+        int conn = ::accept(fd, nullptr, nullptr);
+        if (conn < 0) continue;
+        int noDelay = 1;
+        ::setsockopt(conn, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        std::thread([conn, tt, tablebase] { WorkerConnection(conn, tt, tablebase).serve(); }).detach();
+    }
+}
+
+// ----------------------------------------------------------- coordinator
+
+struct RemoteWorker {
+    std::string address;
+    int fd = -1;
+    std::string buffer;
+    int job = -1;              // root move index being searched, -1 when idle
+    int jobDepth = 0;
+    Clock::time_point started;
+};
+
+struct RootJob {
+    std::string move;
+    bool done = false;
+    double score = 0.0;
+    double ms = 0.0;
+    int runners = 0;           // workers currently searching it
+};
+
+int connectTo(const std::string &address) {
+    std::size_t colon = address.rfind(':');
+    if (colon == std::string::npos) return -1;
+    std::string host = address.substr(0, colon), port = address.substr(colon + 1);
+
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) return -1;
+    int fd = -1;
+    for (addrinfo *a = res; a && fd < 0; a = a->ai_next) {
+        fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) < 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(res);
+    if (fd >= 0) {
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    return fd;
+}
+
+class Coordinator {
+public:
+    Coordinator(std::vector<RemoteWorker> workers_, double slowFactor_)
+        : workers(std::move(workers_)), slowFactor(slowFactor_) {}
+
+    // Iterative deepening with each iteration's root moves spread over the workers
+    bool run(const Board &board, int maxDepth) {
+        std::vector<std::string> moves;
+        for (int fy = 0; fy < 8; ++fy)
+            for (int fx = 0; fx < 8; ++fx)
+                for (int ty = 0; ty < 8; ++ty)
+                    for (int tx = 0; tx < 8; ++tx) {
+                        std::string mv = std::string() + char('a' + fx) + char('8' - fy) + char('a' + tx) + char('8' - ty);
+                        if (board.isMoveValid(mv)) moves.push_back(mv);
+                    }
+        if (moves.empty()) {
+            std::cout << "bestmove none\n";
+            return true;
+        }
+
+        fen = board.toFEN();
+        auto t0 = Clock::now();
+        std::string best;
+        for (int depth = 1; depth <= maxDepth; ++depth) {
+            auto depthStart = Clock::now();
+            int reassignedBefore = reassigned;
+            if (!iterate(moves, depth)) return false;
+
+            // best first, which also orders the next iteration's hand-out
+            std::stable_sort(jobs.begin(), jobs.end(),
+                             [](const RootJob &a, const RootJob &b) { return a.score > b.score; });
+            for (std::size_t i = 0; i < jobs.size(); ++i) moves[i] = jobs[i].move;
+            best = jobs.front().move;
+
+            std::chrono::duration<double, std::milli> took = Clock::now() - depthStart, total = Clock::now() - t0;
+            std::cout << "depth " << depth << " best " << best << " score " << std::fixed << std::setprecision(2)
+                      << jobs.front().score << " nodes " << nodes << " time_ms " << std::setprecision(0)
+                      << took.count() << " total_ms " << total.count() << " reassigned "
+                      << (reassigned - reassignedBefore) << std::endl;
+        }
+        std::cout << "bestmove " << best << std::endl;
+        return true;
+    }
+
+private:
+    std::vector<RemoteWorker> workers;
+    double slowFactor;
+    std::string fen;
+    std::vector<RootJob> jobs;
+    std::deque<int> pending;
+    std::vector<double> finishedMs;
+    uint64_t nodes = 0;
+    int reassigned = 0;
+
+    bool assign(RemoteWorker &w, int job, int depth) {
+        std::ostringstream line;
+        line << "search " << depth << "." << job << " depth " << depth << " move " << jobs[job].move << " fen " << fen;
+        if (!sendLine(w.fd, line.str())) return false;
+        w.job = job;
+        w.jobDepth = depth;
+        w.started = Clock::now();
+        ++jobs[job].runners;
+        return true;
+    }
+
+    void drop(RemoteWorker &w, int depth) {
+        std::cerr << "worker " << w.address << " lost\n";
+        ::close(w.fd);
+        w.fd = -1;
+        if (w.job >= 0 && w.jobDepth == depth && --jobs[w.job].runners == 0 && !jobs[w.job].done)
+            pending.push_front(w.job);
+        w.job = -1;
+    }
+
+    // The longest-running unfinished job, if it is slow enough to hand out twice
+    int slowJob(int depth) const {
+        if (finishedMs.empty()) return -1;
+        std::vector<double> sorted = finishedMs;
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        double limit = std::max(20.0, slowFactor * sorted[sorted.size() / 2]);
+
+        int slowest = -1;
+        double slowestMs = limit;
+        for (const RemoteWorker &w : workers) {
+            if (w.fd < 0 || w.job < 0 || w.jobDepth != depth || jobs[w.job].done || jobs[w.job].runners > 1) continue;
+            std::chrono::duration<double, std::milli> running = Clock::now() - w.started;
+            if (running.count() > slowestMs) {
+                slowestMs = running.count();
+                slowest = w.job;
+            }
+        }
+        return slowest;
+    }
+
+    bool iterate(const std::vector<std::string> &moves, int depth) {
+        jobs.assign(moves.size(), RootJob());
+        pending.clear();
+        finishedMs.clear();
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            jobs[i].move = moves[i];
+            pending.push_back(static_cast<int>(i));
+        }
+        std::size_t remaining = jobs.size();
+
+        while (remaining > 0) {
+            // hand out work: queued moves first, then copies of slow ones
+            for (RemoteWorker &w : workers) {
+                if (w.fd < 0 || w.job >= 0) continue;
+                int job = -1;
+                bool queued = !pending.empty();
+                if (queued) {
+                    job = pending.front();
+                    pending.pop_front();
+                } else {
+                    job = slowJob(depth);
+                }
+                if (job < 0) continue;
+                if (!assign(w, job, depth)) {
+                    if (queued) pending.push_front(job);
+                    drop(w, depth);
+                } else if (!queued) {
+                    ++reassigned;
+                }
+            }
+
+            std::vector<pollfd> fds;
+            std::vector<RemoteWorker *> owners;
+            for (RemoteWorker &w : workers)
+                if (w.fd >= 0) {
+                    fds.push_back({ w.fd, POLLIN, 0 });
+                    owners.push_back(&w);
+                }
+            if (fds.empty()) {
+                std::cerr << "no workers left\n";
+                return false;
+            }
+            if (::poll(fds.data(), fds.size(), 10) <= 0) continue;
+
+            for (std::size_t i = 0; i < fds.size(); ++i) {
+                if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                RemoteWorker &w = *owners[i];
+                std::vector<std::string> lines;
+                if (!readLines(w.fd, w.buffer, lines)) {
+                    drop(w, depth);
+                    continue;
+                }
+                for (const std::string &line : lines) remaining -= handleReply(w, line, depth);
+            }
+        }
+        return true;
+    }
+
+    // Returns 1 when the reply completes a job of this iteration
+    int handleReply(RemoteWorker &w, const std::string &line, int depth) {
+        std::istringstream in(line);
+        std::string kind, id;
+        in >> kind >> id;
+        if (kind != "result" && kind != "stopped" && kind != "error") return 0;
+
+        int job = w.job;
+        bool current = job >= 0 && w.jobDepth == depth && id == std::to_string(depth) + "." + std::to_string(job);
+        std::chrono::duration<double, std::milli> took = Clock::now() - w.started;
+        w.job = -1; // every reply ends the worker's job, stale or not
+        if (!current) return 0;
+        --jobs[job].runners;
+
+        if (kind == "error") {
+            std::cerr << "worker " << w.address << ": " << line << "\n";
+            if (!jobs[job].done && jobs[job].runners == 0) pending.push_back(job);
+            return 0;
+        }
+        if (kind == "stopped" || jobs[job].done) return 0;
+
+        double score = 0.0;
+        uint64_t n = 0;
+        in >> score >> n;
+        jobs[job].done = true;
+        jobs[job].score = score;
+        jobs[job].ms = took.count();
+        finishedMs.push_back(took.count());
+        nodes += n;
+
+        // the other copy of a reassigned job is no longer needed
+        for (RemoteWorker &other : workers)
+            if (other.fd >= 0 && other.job == job && other.jobDepth == depth)
+                sendLine(other.fd, "stop " + id);
+        return 1;
+    }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode != "worker" && mode != "coordinator") {
+        std::cerr << "Usage: distsearch worker [--port N] [--tb dir]\n"
+                     "       distsearch coordinator (--workers host:port,... | --spawn N [--port-base P])\n"
+                     "                              [--depth N] [--slow-factor X] fen <FEN>\n";
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int port = 9100, spawn = 0, depth = 4;
+    double slowFactor = 3.0;
+    std::string workerList, fen;
+    Tablebase tablebase;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "fen") {
+            for (++i; i < argc; ++i) fen += std::string(fen.empty() ? "" : " ") + argv[i];
+        } else if ((arg == "--port" || arg == "--port-base") && hasValue) port = std::atoi(argv[++i]);
+        else if (arg == "--tb" && hasValue) tablebase.load(argv[++i]);
+        else if (arg == "--workers" && hasValue) workerList = argv[++i];
+        else if (arg == "--spawn" && hasValue) spawn = std::atoi(argv[++i]);
+        else if (arg == "--depth" && hasValue) depth = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--slow-factor" && hasValue) slowFactor = std::atof(argv[++i]);
+    }
+
+    if (mode == "worker") return runWorker(port, tablebase.tableCount() > 0 ? &tablebase : nullptr);
+
+    Board board;
+    if (!fen.empty() && !board.loadFEN(fen)) {
+        std::cerr << "Bad FEN: " << fen << "\n";
+        return 1;
+    }
+
+    // --spawn starts local workers on consecutive ports (for testing on one machine)
+    std::vector<pid_t> children;
+    std::vector<std::string> addresses;
+    for (int i = 0; i < spawn; ++i) {
+        std::string p = std::to_string(port + i);
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            ::execl(argv[0], argv[0], "worker", "--port", p.c_str(), static_cast<char *>(nullptr));
+            std::_Exit(127);
+        }
+        children.push_back(pid);
+        addresses.push_back("127.0.0.1:" + p);
+    }
+    std::istringstream list(workerList);
+    for (std::string a; std::getline(list, a, ',');)
+        if (!a.empty()) addresses.push_back(a);
+
+    std::vector<RemoteWorker> workers;
+    for (const std::string &a : addresses) {
+        RemoteWorker w;
+        w.address = a;
+        // spawned workers need a moment before they listen
+        for (int attempt = 0; attempt < 50 && (w.fd = connectTo(a)) < 0; ++attempt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (w.fd < 0) std::cerr << "cannot reach worker " << a << "\n";
+        else workers.push_back(std::move(w));
+    }
+
+    bool ok = false;
+    if (workers.empty()) std::cerr << "no workers\n";
+    else {
+        std::cout << "searching with " << workers.size() << " workers" << std::endl;
+        ok = Coordinator(std::move(workers), slowFactor).run(board, depth);
+    }
+
+    for (pid_t pid : children) {
+        ::kill(pid, SIGTERM);
+        ::waitpid(pid, nullptr, 0);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+#include "Board.hpp"
+#include "AIPlayer.hpp"
+#include "Tablebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs an EPD test suite (WAC, ECM, ...) and reports, per position, whether the
+// engine found a "bm" move (and avoided any "am" move), the nodes searched and
+// the time-to-solution: when the final, correct answer first appeared.
+// Usage: epd <suite.epd> [--depth N] [--threads N] [--tb dir] [--mate-nodes N]
+
+struct EpdPosition {
+    std::string id;
+    std::string fen;
+    std::vector<std::string> bestMoves;   // coordinate format
+    std::vector<std::string> avoidMoves;
+    std::string bestSan;                  // as written in the file, for the report
+};
+
+struct EpdResult {
+    std::string move;
+    bool solved = false;
+    uint64_t nodes = 0;
+    double timeMs = 0.0;
+    double solvedAtMs = -1.0;  // time-to-solution, -1 if never solved
+    int solvedAtDepth = 0;
+    int solvedMateIn = 0;      // proven by the mate solver instead: mate in N moves
+};
+
+static std::string trim(const std::string &s) {
+    std::size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    std::size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+// "<4 FEN fields> bm Qg6; id "WAC.001";"
+static bool parseEpdLine(const std::string &line, EpdPosition &pos) {
+    std::istringstream in(line);
+    std::string fields[4];
+    for (auto &f : fields)
+        if (!(in >> f)) return false;
+    pos.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+
+    Board board;
+    if (!board.loadFEN(pos.fen)) return false;
+
+    std::string rest;
+    std::getline(in, rest);
+    std::istringstream ops(rest);
+    std::string op;
+    while (std::getline(ops, op, ';')) {
+        op = trim(op);
+        if (op.empty()) continue;
+        std::size_t space = op.find(' ');
+        std::string code = op.substr(0, space);
+        std::string operands = (space == std::string::npos) ? "" : trim(op.substr(space + 1));
+
+        if (code == "id") {
+            operands.erase(std::remove(operands.begin(), operands.end(), '"'), operands.end());
+            pos.id = operands;
+        } else if (code == "bm" || code == "am") {
+            if (code == "bm") pos.bestSan = operands;
+            std::istringstream sans(operands);
+            std::string san;
+            while (sans >> san) {
+                std::string mv = board.moveFromSAN(san);
+                if (mv.empty()) return false;
+                (code == "bm" ? pos.bestMoves : pos.avoidMoves).push_back(mv);
+            }
+        }
+    }
+    return !pos.bestMoves.empty() || !pos.avoidMoves.empty();
+}
+
+static bool isSolution(const EpdPosition &pos, const std::string &move) {
+    if (!pos.bestMoves.empty() &&
+        std::find(pos.bestMoves.begin(), pos.bestMoves.end(), move) == pos.bestMoves.end())
+        return false;
+    return std::find(pos.avoidMoves.begin(), pos.avoidMoves.end(), move) == pos.avoidMoves.end();
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: epd <suite.epd> [--depth N] [--threads N] [--tb dir] [--mate-nodes N]\n";
+        return 1;
+    }
+
+    int depth = 3;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    uint64_t mateNodes = 0;
+    Tablebase tablebase;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--depth") depth = std::atoi(argv[i + 1]);
+        else if (arg == "--threads") threads = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--tb") tablebase.load(argv[i + 1]);
+        else if (arg == "--mate-nodes") mateNodes = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<EpdPosition> suite;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(file, line)) {
+        ++lineNo;
+        if (trim(line).empty() || line[0] == '#') continue;
+        EpdPosition pos;
+        if (!parseEpdLine(line, pos)) {
+            std::cerr << "Skipping unreadable EPD line " << lineNo << "\n";
+            continue;
+        }
+        if (pos.id.empty()) pos.id = "line " + std::to_string(lineNo);
+        suite.push_back(pos);
+    }
+
+    // Each worker takes the next position and searches it with a
+    // fresh AIPlayer, so per-position numbers do not depend on scheduling.
+    std::vector<EpdResult> results(suite.size());
+    std::atomic<std::size_t> next{ 0 };
+    std::mutex printMutex;
+
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < suite.size(); i = next++) {
+            const EpdPosition &pos = suite[i];
+            Board board;
+            board.loadFEN(pos.fen);
+
+            AIPlayer ai(board.getCurrentPlayer(), depth);
+            ai.setRandomBias(false); // the same result on every run
+            if (tablebase.tableCount() > 0) ai.setTablebase(&tablebase);
+            ai.setMateSearch(mateNodes);
+
+            EpdResult &r = results[i];
+            ai.setInfoCallback([&](const SearchInfo &info) {
+                if (!isSolution(pos, info.bestMove)) {
+                    r.solvedAtMs = -1.0;
+                } else if (r.solvedAtMs < 0) {
+                    r.solvedAtMs = info.elapsedMs;
+                    r.solvedAtDepth = info.depth;
+                }
+            });
+
+            auto t0 = std::chrono::steady_clock::now();
+            r.move = ai.findBestMove(board);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - t0;
+            r.timeMs = elapsed.count();
+            r.nodes = ai.lastSearchStats().nodes + ai.lastSearchStats().mateNodes;
+            r.solved = isSolution(pos, r.move);
+            if (!r.solved) r.solvedAtMs = -1.0;
+            else if (ai.lastSearchStats().depths.empty()) {
+                // proven by the mate solver: no depths reported, the PV runs to the mate
+                r.solvedAtMs = r.timeMs;
+                r.solvedMateIn = static_cast<int>(ai.lastSearchStats().pv.size() + 1) / 2;
+            }
+
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cerr << "[" << pos.id << "] " << (r.solved ? "solved" : "failed") << "\n";
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for (auto &th : pool) th.join();
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - t0;
+
+    int solved = 0;
+    uint64_t totalNodes = 0;
+    double totalTime = 0.0;
+    std::cout << std::left << std::setw(14) << "id" << std::setw(8) << "result" << std::setw(8) << "move"
+              << std::setw(12) << "expected" << std::right << std::setw(12) << "nodes"
+              << std::setw(12) << "time ms" << std::setw(14) << "solved at ms" << "\n";
+    for (std::size_t i = 0; i < suite.size(); ++i) {
+        const EpdResult &r = results[i];
+        solved += r.solved;
+        totalNodes += r.nodes;
+        totalTime += r.timeMs;
+        std::cout << std::left << std::setw(14) << suite[i].id << std::setw(8) << (r.solved ? "ok" : "FAIL")
+                  << std::setw(8) << r.move << std::setw(12) << suite[i].bestSan << std::right
+                  << std::setw(12) << r.nodes << std::setw(12) << std::fixed << std::setprecision(1) << r.timeMs;
+        if (r.solved && r.solvedMateIn) std::cout << std::setw(8) << r.solvedAtMs << " (mate " << r.solvedMateIn << ")";
+        else if (r.solved) std::cout << std::setw(8) << r.solvedAtMs << " (d" << r.solvedAtDepth << ")";
+        std::cout << "\n";
+    }
+
+    std::cout << "\nSolved " << solved << " / " << suite.size() << " at depth " << depth << "\n";
+    std::cout << "Nodes: " << totalNodes << "   search time: " << std::setprecision(0) << totalTime
+              << " ms   wall: " << wall.count() << " ms   threads: " << threads << "\n";
+    return 0;
+}
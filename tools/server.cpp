@@ -0,0 +1,407 @@
+#include "Board.hpp"
+#include "AIPlayer.hpp"
+#include "MateSolver.hpp"
+#include "Tablebase.hpp"
+#include "SharedTranspositionTable.hpp"
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Long-running analysis server. Front ends connect over a Unix or TCP socket
+// and send line-based requests; every connection is a session, and all
+// sessions share one worker pool and one transposition table.
+//
+//   go [id <tag>] [depth N] [movetime MS] [nodes N] [multipv N] fen <FEN>
+//       -> info <tag> depth D multipv K score S nodes N pv <moves>
+//                                  (per completed depth, one line per root line)
+//       -> bestmove <tag> <move> score S depth D nodes N queue_ms Q search_ms T
+//   mate [id <tag>] [moves N] [nodes N] fen <FEN>
+//       -> mate <tag> <move> in M nodes N pv <moves>   or   nomate <tag> nodes N
+//                                  (df-pn mate search, default 3 moves / 1M nodes)
+//   stop     stop this session's queued and running requests
+//   stats    one JSON line: queue depth, latency percentiles, TT size
+//   quit     close the session
+//
+// Usage: server [--unix path | --port N] [--threads N] [--hash N] [--tb dir]
+//               [--shared-tt name [--hash-mb N] [--huge-pages]]
+
+namespace {
+
+struct Session {
+    int fd;
+    std::mutex writeMutex;
+    std::mutex stopMutex;
+    std::stop_source stop;   // replaced after every "stop"
+    std::atomic<bool> closed{ false };
+
+    explicit Session(int fd_) : fd(fd_) {}
+    ~Session() { ::close(fd); }
+
+    void send(const std::string &line) {
+        if (closed) return;
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::string out = line + "\n";
+        for (std::size_t off = 0; off < out.size();) {
+            ssize_t n = ::send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+            if (n <= 0) { closed = true; return; }
+            off += static_cast<std::size_t>(n);
+        }
+    }
+
+    std::stop_token token() {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        return stop.get_token();
+    }
+
+    void stopAll() {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stop.request_stop();
+        stop = std::stop_source();
+    }
+};
+
+struct Request {
+    std::shared_ptr<Session> session;
+    std::string tag;
+    Board board;
+    SearchLimits limits;
+    int mateMoves = 0;       // > 0: a mate search instead of a normal one
+    std::stop_token stop;
+    std::chrono::steady_clock::time_point queued;
+};
+
+// Latency of the most recent requests plus queue counters
+class Metrics {
+public:
+    void enqueued(std::size_t depth) {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxQueueDepth = std::max(maxQueueDepth, depth);
+    }
+
+    void finished(double queueMs, double searchMs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++completed;
+        if (latencies.size() == WINDOW) latencies.pop_front();
+        latencies.push_back(queueMs + searchMs);
+        totalQueueMs += queueMs;
+        totalSearchMs += searchMs;
+    }
+
+    std::string json(std::size_t queueDepth, int running, std::size_t ttEntries) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<double> v(latencies.begin(), latencies.end());
+        std::sort(v.begin(), v.end());
+        auto pct = [&](double p) { return v.empty() ? 0.0 : v[std::min(v.size() - 1, std::size_t(p * v.size()))]; };
+        double n = completed ? static_cast<double>(completed) : 1.0;
+
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1) << "{\"queue_depth\":" << queueDepth
+            << ",\"max_queue_depth\":" << maxQueueDepth << ",\"running\":" << running
+            << ",\"completed\":" << completed << ",\"mean_queue_ms\":" << totalQueueMs / n
+            << ",\"mean_search_ms\":" << totalSearchMs / n << ",\"latency_ms\":{\"p50\":" << pct(0.50)
+            << ",\"p95\":" << pct(0.95) << ",\"p99\":" << pct(0.99) << ",\"max\":" << (v.empty() ? 0.0 : v.back())
+            << "},\"tt_entries\":" << ttEntries << "}";
+        return out.str();
+    }
+
+private:
+    static constexpr std::size_t WINDOW = 4096;
+    std::mutex mutex;
+    std::deque<double> latencies;
+    std::size_t maxQueueDepth = 0;
+    uint64_t completed = 0;
+    double totalQueueMs = 0.0, totalSearchMs = 0.0;
+};
+
+class Server {
+public:
+    Server(int threads, std::shared_ptr<TranspositionTable> table, const Tablebase *tablebase)
+        : tt(std::move(table)), tablebase(tablebase) {
+        for (int i = 0; i < threads; ++i) workers.emplace_back([this] { work(); });
+    }
+
+    ~Server() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            shuttingDown = true;
+        }
+        queueReady.notify_all();
+        for (auto &w : workers) w.join();
+    }
+
+    // One thread per connection reads requests; the searches run on the pool
+    void serve(int fd) {
+        auto session = std::make_shared<Session>(fd);
+        std::string buffer;
+        char chunk[4096];
+        while (!session->closed) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) break;
+            buffer.append(chunk, static_cast<std::size_t>(n));
+            std::size_t nl;
+            while ((nl = buffer.find('\n')) != std::string::npos) {
+                std::string line = buffer.substr(0, nl);
+                buffer.erase(0, nl + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!handle(session, line)) session->closed = true;
+            }
+        }
+        // a dropped client's work is no longer wanted
+        session->closed = true;
+        session->stopAll();
+    }
+
+private:
+    std::shared_ptr<TranspositionTable> tt;
+    std::shared_ptr<EvalCache> evalCache = std::make_shared<EvalCache>(1u << 20); // shared by all workers
+    const Tablebase *tablebase;
+    Metrics metrics;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Request> queue;
+    bool shuttingDown = false;
+    std::atomic<int> running{ 0 };
+    std::vector<std::thread> workers;
+
+    bool handle(const std::shared_ptr<Session> &session, const std::string &line) {
+        std::istringstream in(line);
+        std::string cmd;
+        if (!(in >> cmd)) return true;
+
+        if (cmd == "quit") return false;
+        if (cmd == "stop") {
+            session->stopAll();
+            return true;
+        }
+        if (cmd == "stats") {
+            std::size_t depth;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                depth = queue.size();
+            }
+            session->send("stats " + metrics.json(depth, running, tt->size()));
+            return true;
+        }
+        if (cmd != "go" && cmd != "mate") {
+            session->send("error unknown command '" + cmd + "'");
+            return true;
+        }
+
+        Request req;
+        req.session = session;
+        req.tag = "-";
+        if (cmd == "mate") req.mateMoves = 3;
+        std::string word, fen;
+        while (in >> word) {
+            if (word == "id") in >> req.tag;
+            else if (word == "depth") in >> req.limits.depth;
+            else if (word == "movetime") in >> req.limits.movetimeMs;
+            else if (word == "nodes") in >> req.limits.nodes;
+            else if (word == "multipv") in >> req.limits.multiPV;
+            else if (word == "moves" && req.mateMoves > 0) in >> req.mateMoves;
+            else if (word == "fen") {
+                std::getline(in >> std::ws, fen);
+                break;
+            } else {
+                session->send("error " + req.tag + " unknown option '" + word + "'");
+                return true;
+            }
+        }
+        if (fen.empty() || !req.board.loadFEN(fen)) {
+            session->send("error " + req.tag + " bad or missing fen");
+            return true;
+        }
+        if (req.mateMoves > 0) {
+            req.mateMoves = std::max(1, req.mateMoves);
+            if (req.limits.nodes == 0) req.limits.nodes = 1000000;
+        } else if (req.limits.depth <= 0 && req.limits.movetimeMs <= 0 && req.limits.nodes == 0) {
+            req.limits.movetimeMs = 1000;
+        }
+        req.stop = session->token();
+        req.queued = std::chrono::steady_clock::now();
+
+        std::size_t depth;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(req));
+            depth = queue.size();
+        }
+        metrics.enqueued(depth);
+        queueReady.notify_one();
+        return true;
+    }
+
+    void work() {
+        for (;;) {
+            Request req;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this] { return shuttingDown || !queue.empty(); });
+                if (shuttingDown && queue.empty()) return;
+                req = std::move(queue.front());
+                queue.pop_front();
+            }
+            ++running;
+            if (req.mateMoves > 0) solveMate(req);
+            else run(req);
+            --running;
+        }
+    }
+
+    void run(const Request &req) {
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+        std::chrono::duration<double, std::milli> waited = start - req.queued;
+        Session &session = *req.session;
+
+        AIPlayer ai(req.board.getCurrentPlayer(), 1);
+        ai.setTranspositionTable(tt);
+        ai.setEvalCache(evalCache);
+        ai.setRandomBias(false); // an analysis answer: same request, same move and score
+        if (tablebase) ai.setTablebase(tablebase);
+
+        SearchResult r = ai.runSearch(req.board, req.limits, req.stop, [&](const SearchInfo &info) {
+            for (std::size_t k = 0; k < info.lines.size(); ++k) {
+                std::ostringstream line;
+                line << "info " << req.tag << " depth " << info.depth << " multipv " << k + 1
+                     << " score " << info.lines[k].score << " nodes " << info.nodes << " pv";
+                for (const std::string &mv : info.lines[k].pv) line << " " << mv;
+                session.send(line.str());
+            }
+        });
+
+        std::chrono::duration<double, std::milli> searched = Clock::now() - start;
+        metrics.finished(waited.count(), searched.count());
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "bestmove " << req.tag << " "
+             << (r.bestMove.empty() ? "none" : r.bestMove) << " score " << r.score << " depth "
+             << (r.stats.depths.empty() ? 0 : r.stats.depths.back().depth) << " nodes " << r.stats.nodes
+             << " queue_ms " << waited.count() << " search_ms " << searched.count();
+        session.send(line.str());
+    }
+
+    // Mate searches keep their table per worker thread: it is bounded and
+    // the df-pn numbers are only valid for one attacker anyway
+    void solveMate(const Request &req) {
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+        std::chrono::duration<double, std::milli> waited = start - req.queued;
+        thread_local MateSolver solver(1u << 20);
+
+        MateSolver::Result r = solver.solve(req.board, req.mateMoves, req.limits.nodes, req.stop);
+        std::chrono::duration<double, std::milli> searched = Clock::now() - start;
+        metrics.finished(waited.count(), searched.count());
+
+        std::ostringstream line;
+        if (r.mate) {
+            line << "mate " << req.tag << " " << r.move << " in " << r.mateIn << " nodes " << r.nodes << " pv";
+            for (const std::string &mv : r.pv) line << " " << mv;
+        } else {
+            line << "nomate " << req.tag << " nodes " << r.nodes;
+        }
+        req.session->send(line.str());
+    }
+};
+
+int listenOn(const std::string &unixPath, int port) {
+    int fd;
+    if (!unixPath.empty()) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (unixPath.size() >= sizeof(addr.sun_path)) return -1;
+        std::copy(unixPath.begin(), unixPath.end(), addr.sun_path);
+        ::unlink(unixPath.c_str());
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) return -1;
+    } else {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // local front ends only
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) return -1;
+    }
+    if (::listen(fd, 64) < 0) return -1;
+    return fd;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string unixPath;
+    int port = 7878;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::size_t hashEntries = 4000000, hashMb = 256;
+    std::string sharedName;
+    bool hugePages = false;
+    Tablebase tablebase;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue) unixPath = argv[++i];
+        else if (arg == "--port" && hasValue) port = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--hash" && hasValue) hashEntries = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--tb" && hasValue) tablebase.load(argv[++i]);
+        else if (arg == "--shared-tt" && hasValue) sharedName = argv[++i];
+        else if (arg == "--hash-mb" && hasValue) hashMb = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--huge-pages") hugePages = true;
+        else {
+            std::cerr << "Usage: server [--unix path | --port N] [--threads N] [--hash N] [--tb dir]\n"
+                         "              [--shared-tt name [--hash-mb N] [--huge-pages]]\n";
+            return 1;
+        }
+    }
+
+    // The table is private to this process unless a shared segment is named
+    std::shared_ptr<TranspositionTable> tt;
+    if (!sharedName.empty()) {
+        auto shared = std::make_shared<SharedTranspositionTable>();
+        if (!shared->attach(sharedName, hashMb, hugePages)) {
+            std::cerr << "Cannot attach shared transposition table " << sharedName << "\n";
+            return 1;
+        }
+        tt = shared;
+    } else {
+        tt = std::make_shared<LocalTranspositionTable>(hashEntries);
+    }
+
+    int listenFd = listenOn(unixPath, port);
+    if (listenFd < 0) {
+        std::cerr << "Cannot listen on " << (unixPath.empty() ? "port " + std::to_string(port) : unixPath) << "\n";
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Server server(threads, tt, tablebase.tableCount() > 0 ? &tablebase : nullptr);
+    std::cout << "Listening on " << (unixPath.empty() ? "127.0.0.1:" + std::to_string(port) : unixPath)
+              << " with " << threads << " workers" << std::endl;
+
+    for (;;) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::thread([&server, fd] { server.serve(fd); }).detach();
+    }
+}
@@ -0,0 +1,42 @@
+#include "Tablebase.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+
+// Builds the 3- and 4-man endgame tablebases.
+// Usage: tbgen <output dir> [--threads N] [--pieces 3|4]
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: tbgen <output dir> [--threads N] [--pieces 3|4]\n";
+        return 1;
+    }
+
+    std::string dir = argv[1];
+    int threads = 0;
+    int pieces = 4;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--threads") threads = std::atoi(argv[i + 1]);
+        else if (arg == "--pieces") pieces = std::atoi(argv[i + 1]);
+    }
+    if (pieces < 3 || pieces > 4) {
+        std::cerr << "--pieces must be 3 or 4\n";
+        return 1;
+    }
+
+    mkdir(dir.c_str(), 0755);
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = Tablebase::generate(dir, threads, pieces, [&](const std::string &line) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+        std::cout << "[" << static_cast<int>(elapsed.count()) << "s] " << line << std::endl;
+    });
+    if (!ok) {
+        std::cerr << "Tablebase generation failed\n";
+        return 1;
+    }
+    std::cout << "Tablebases written to " << dir << "\n";
+    return 0;
+}